@@ -1,7 +1,62 @@
 #include "Six.h"
 #include <algorithm>
 #include <stdexcept>
+#include <cstdint>
 #include <cstring>
+#include <istream>
+#include <utility>
+
+namespace {
+
+const size_t kStreamChunk = 1 << 16;
+
+uint64_t load64(const unsigned char* p) {
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+uint64_t mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+// A plain loop without an early exit: every byte is checked, which keeps
+// the scan simple for the optimizer.
+bool allBase6Digits(const char* p, size_t n) {
+    unsigned char bad = 0;
+    for (size_t i = 0; i < n; ++i) {
+        bad |= static_cast<unsigned char>(p[i] - '0') > 5;
+    }
+    return bad == 0;
+}
+
+// Bytes left in a seekable stream, or 0 if the stream cannot tell.
+size_t remainingBytes(std::istream& in) {
+    std::istream::pos_type pos = in.tellg();
+    if (pos == std::istream::pos_type(-1)) {
+        return 0;
+    }
+    in.seekg(0, std::ios::end);
+    std::istream::pos_type end = in.tellg();
+    in.seekg(pos);
+    if (end == std::istream::pos_type(-1) || !in || end < pos) {
+        in.clear();
+        in.seekg(pos);
+        return 0;
+    }
+    return static_cast<size_t>(end - pos);
+}
+
+}
 
 void Six::validateDigit(unsigned char digit) const {
     if (digit >= 6) {
@@ -80,6 +135,94 @@ Six::Six(const std::string& t) : _size(t.length()), _array(nullptr) {
     removeLeadingZeros();
 }
 
+Six::Six(const SixLiteral& t) : _size(t.size()), _array(new unsigned char[t.size()]) {
+    for (size_t i = 0; i < _size; ++i) {
+        _array[i] = t.digit(i);
+    }
+}
+
+// Reads the whole stream: optional surrounding whitespace around a single
+// base-6 number. Digits are appended most significant first and reversed
+// in place at the end. A seekable stream sizes the buffer once from its
+// remaining length; otherwise the buffer grows by half and is trimmed at
+// the end if more than 1/16 of it is unused.
+Six::Six(std::istream& in) : _size(0), _array(nullptr) {
+    in >> std::ws;
+
+    size_t capacity = remainingBytes(in);
+    if (capacity > 0) {
+        _array = new unsigned char[capacity];
+    }
+    bool sawDigit = false;
+    bool leading = true;
+    bool finished = false;
+    char chunk[kStreamChunk];
+
+    try {
+        while (in.read(chunk, kStreamChunk) || in.gcount() > 0) {
+            const char* p = chunk;
+            const char* end = chunk + in.gcount();
+
+            if (!finished) {
+                const char* stop = std::find_if(p, end, isSpace);
+                if (!allBase6Digits(p, stop - p)) {
+                    throw std::invalid_argument("Invalid digit for base-6 number");
+                }
+                sawDigit = sawDigit || (stop != p);
+                if (leading) {
+                    while (p != stop && *p == '0') ++p;
+                    leading = (p == stop);
+                }
+
+                size_t n = stop - p;
+                if (_size + n > capacity) {
+                    size_t newCapacity = std::max(_size + n, capacity + capacity / 2);
+                    unsigned char* newArray = new unsigned char[newCapacity];
+                    std::copy(_array, _array + _size, newArray);
+                    delete[] _array;
+                    _array = newArray;
+                    capacity = newCapacity;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    _array[_size + i] = p[i] - '0';
+                }
+                _size += n;
+
+                finished = (stop != end);
+                p = stop;
+            }
+
+            if (!std::all_of(p, end, isSpace)) {
+                throw std::invalid_argument("Invalid digit for base-6 number");
+            }
+        }
+    } catch (...) {
+        delete[] _array;
+        throw;
+    }
+
+    in.clear(std::ios::eofbit);
+
+    if (!sawDigit) {
+        delete[] _array;
+        throw std::invalid_argument("Stream contains no base-6 digits");
+    }
+    if (_size == 0) {
+        delete[] _array;
+        _array = new unsigned char[1];
+        _array[0] = 0;
+        _size = 1;
+        return;
+    }
+    if (capacity - _size > _size / 16) {
+        unsigned char* trimmed = new unsigned char[_size];
+        std::copy(_array, _array + _size, trimmed);
+        delete[] _array;
+        _array = trimmed;
+    }
+    std::reverse(_array, _array + _size);
+}
+
 Six::Six(const Six& other) : _size(other._size), _array(nullptr) {
     if (_size > 0) {
         _array = new unsigned char[_size];
@@ -156,16 +299,35 @@ Six Six::subtract(const Six& other) const {
     return result;
 }
 
+Six Six::multiply(const Six& other) const {
+    Six result(_size + other._size, 0);
+
+    for (size_t i = 0; i < _size; ++i) {
+        if (_array[i] == 0) continue;
+        unsigned int carry = 0;
+        for (size_t j = 0; j < other._size; ++j) {
+            unsigned int cur = result._array[i + j] + _array[i] * other._array[j] + carry;
+            result._array[i + j] = cur % 6;
+            carry = cur / 6;
+        }
+        for (size_t k = i + other._size; carry; ++k) {
+            unsigned int cur = result._array[k] + carry;
+            result._array[k] = cur % 6;
+            carry = cur / 6;
+        }
+    }
+
+    result.removeLeadingZeros();
+    return result;
+}
+
 Six Six::copy() const {
     return Six(*this);
 }
 
 bool Six::equals(const Six& other) const {
     if (_size != other._size) return false;
-    for (size_t i = 0; i < _size; ++i) {
-        if (_array[i] != other._array[i]) return false;
-    }
-    return true;
+    return _size == 0 || std::memcmp(_array, other._array, _size) == 0;
 }
 
 bool Six::greaterThan(const Six& other) const {
@@ -185,6 +347,47 @@ bool Six::lessThan(const Six& other) const {
     return !equals(other) && !greaterThan(other);
 }
 
+// Four independent multiply-xor lanes over 32-byte blocks keep several
+// multiplications in flight; the tail is folded in eight bytes at a time.
+size_t Six::hash() const {
+    const uint64_t k = 0x9e3779b97f4a7c15ULL;
+    uint64_t h0 = _size, h1 = k, h2 = ~k, h3 = _size * k;
+    size_t i = 0;
+    for (; i + 32 <= _size; i += 32) {
+        h0 = (h0 ^ load64(_array + i)) * k;
+        h1 = (h1 ^ load64(_array + i + 8)) * k;
+        h2 = (h2 ^ load64(_array + i + 16)) * k;
+        h3 = (h3 ^ load64(_array + i + 24)) * k;
+    }
+    for (; i + 8 <= _size; i += 8) {
+        h0 = (h0 ^ load64(_array + i)) * k;
+    }
+    uint64_t tail = 0;
+    for (size_t j = 0; i + j < _size; ++j) {
+        tail |= static_cast<uint64_t>(_array[i + j]) << (8 * j);
+    }
+    h1 = (h1 ^ tail) * k;
+
+    uint64_t h = mix64(h0) ^ mix64(h1 + 1) ^ mix64(h2 + 2) ^ mix64(h3 + 3);
+    return static_cast<size_t>(mix64(h));
+}
+
+HashedSix::HashedSix(const Six& value) : _value(value), _hash(value.hash()) {}
+
+HashedSix::HashedSix(Six&& value) : _value(std::move(value)), _hash(_value.hash()) {}
+
+const Six& HashedSix::value() const {
+    return _value;
+}
+
+size_t HashedSix::hash() const {
+    return _hash;
+}
+
+bool HashedSix::equals(const HashedSix& other) const {
+    return _hash == other._hash && _value.equals(other._value);
+}
+
 Six& Six::operator=(const Six& other) {
     if (this != &other) {
         delete[] _array;
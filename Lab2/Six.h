@@ -1,8 +1,13 @@
 #ifndef SIX_H
 #define SIX_H
 
+#include <functional>
 #include <string>
+#include <iosfwd>
 #include <stdexcept>
+#include "SixLiteral.h"
+
+class SixView;
 
 class Six {
 private:
@@ -12,11 +17,19 @@ private:
     void validateDigit(unsigned char digit) const;
     void removeLeadingZeros();
     void resize(size_t newSize);
+
+    friend class SixView;
+    friend class SixBatch;
+    friend class SixModContext;
+    friend void writeBinary(const Six& value, std::ostream& out);
+    friend Six readBinary(std::istream& in);
     
 public:
     Six();
     explicit Six(const size_t& n, unsigned char t = 0);
     explicit Six(const std::string& t);
+    Six(const SixLiteral& t);
+    explicit Six(std::istream& in);
     Six(const Six& other);
     Six(Six&& other) noexcept;
 
@@ -27,14 +40,64 @@ public:
 
     Six add(const Six& other) const;
     Six subtract(const Six& other) const;
+    Six multiply(const Six& other) const;
     Six copy() const;
 
     bool equals(const Six& other) const;
     bool greaterThan(const Six& other) const;
     bool lessThan(const Six& other) const;
+    size_t hash() const;
 
     Six& operator=(const Six& other);
     Six& operator=(Six&& other) noexcept;
 };
 
+// Six together with its precomputed hash, for keys that are hashed
+// repeatedly (e.g. probed in several tables).
+class HashedSix {
+private:
+    Six _value;
+    size_t _hash;
+
+public:
+    explicit HashedSix(const Six& value);
+    explicit HashedSix(Six&& value);
+
+    const Six& value() const;
+    size_t hash() const;
+    bool equals(const HashedSix& other) const;
+};
+
+namespace std {
+
+template <>
+struct hash<Six> {
+    size_t operator()(const Six& value) const {
+        return value.hash();
+    }
+};
+
+template <>
+struct equal_to<Six> {
+    bool operator()(const Six& a, const Six& b) const {
+        return a.equals(b);
+    }
+};
+
+template <>
+struct hash<HashedSix> {
+    size_t operator()(const HashedSix& value) const {
+        return value.hash();
+    }
+};
+
+template <>
+struct equal_to<HashedSix> {
+    bool operator()(const HashedSix& a, const HashedSix& b) const {
+        return a.equals(b);
+    }
+};
+
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "SixBatch.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Checked before the digit storage is allocated.
+size_t digitCount(size_t count, size_t width) {
+    if (width == 0) {
+        throw std::invalid_argument("Width cannot be zero");
+    }
+    if (count > std::numeric_limits<size_t>::max() / width) {
+        throw std::length_error("Batch size overflows");
+    }
+    return count * width;
+}
+
+}
+
+SixBatch::SixBatch(size_t count, size_t width) : _count(count), _width(width), _digits(digitCount(count, width), 0) {}
+
+SixBatch::SixBatch(const std::vector<Six>& values, size_t width) : SixBatch(values.size(), width) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        set(i, values[i]);
+    }
+}
+
+void SixBatch::checkCompatible(const SixBatch& other) const {
+    if (_count != other._count || _width != other._width) {
+        throw std::invalid_argument("Batches must have the same count and width");
+    }
+}
+
+size_t SixBatch::count() const {
+    return _count;
+}
+
+size_t SixBatch::width() const {
+    return _width;
+}
+
+void SixBatch::set(size_t index, const Six& value) {
+    if (index >= _count) {
+        throw std::out_of_range("Batch index out of range");
+    }
+    if (value._size > _width) {
+        throw std::overflow_error("Value does not fit the batch width");
+    }
+    for (size_t d = 0; d < _width; ++d) {
+        _digits[d * _count + index] = d < value._size ? value._array[d] : 0;
+    }
+}
+
+Six SixBatch::get(size_t index) const {
+    if (index >= _count) {
+        throw std::out_of_range("Batch index out of range");
+    }
+    size_t size = _width;
+    while (size > 1 && _digits[(size - 1) * _count + index] == 0) {
+        --size;
+    }
+    Six result(size, 0);
+    for (size_t d = 0; d < size; ++d) {
+        result._array[d] = _digits[d * _count + index];
+    }
+    return result;
+}
+
+std::vector<Six> SixBatch::toVector() const {
+    std::vector<Six> result;
+    result.reserve(_count);
+    for (size_t i = 0; i < _count; ++i) {
+        result.push_back(get(i));
+    }
+    return result;
+}
+
+// The per-lane loops below are branch-free so they vectorize across the
+// batch; carries and borrows live in their own lane-wide buffer.
+SixBatch SixBatch::add(const SixBatch& other) const {
+    checkCompatible(other);
+    SixBatch result(_count, _width);
+    if (_count == 0) {
+        return result;
+    }
+    std::vector<unsigned char> carry(_count, 0);
+
+    for (size_t d = 0; d < _width; ++d) {
+        const unsigned char* a = _digits.data() + d * _count;
+        const unsigned char* b = other._digits.data() + d * _count;
+        unsigned char* out = result._digits.data() + d * _count;
+        for (size_t i = 0; i < _count; ++i) {
+            unsigned char sum = a[i] + b[i] + carry[i];
+            unsigned char c = sum >= 6;
+            out[i] = sum - 6 * c;
+            carry[i] = c;
+        }
+    }
+
+    if (std::any_of(carry.begin(), carry.end(), [](unsigned char c) { return c != 0; })) {
+        throw std::overflow_error("Batch addition overflows the fixed width");
+    }
+    return result;
+}
+
+SixBatch SixBatch::subtract(const SixBatch& other) const {
+    checkCompatible(other);
+    SixBatch result(_count, _width);
+    if (_count == 0) {
+        return result;
+    }
+    std::vector<unsigned char> borrow(_count, 0);
+
+    for (size_t d = 0; d < _width; ++d) {
+        const unsigned char* a = _digits.data() + d * _count;
+        const unsigned char* b = other._digits.data() + d * _count;
+        unsigned char* out = result._digits.data() + d * _count;
+        for (size_t i = 0; i < _count; ++i) {
+            int diff = a[i] - b[i] - borrow[i];
+            unsigned char c = diff < 0;
+            out[i] = static_cast<unsigned char>(diff + 6 * c);
+            borrow[i] = c;
+        }
+    }
+
+    if (std::any_of(borrow.begin(), borrow.end(), [](unsigned char c) { return c != 0; })) {
+        throw std::underflow_error("Subtraction would result in negative number");
+    }
+    return result;
+}
+
+std::vector<signed char> SixBatch::compare(const SixBatch& other) const {
+    checkCompatible(other);
+    std::vector<signed char> result(_count, 0);
+    if (_count == 0) {
+        return result;
+    }
+
+    for (size_t d = _width; d-- > 0;) {
+        const unsigned char* a = _digits.data() + d * _count;
+        const unsigned char* b = other._digits.data() + d * _count;
+        for (size_t i = 0; i < _count; ++i) {
+            signed char c = static_cast<signed char>((a[i] > b[i]) - (a[i] < b[i]));
+            result[i] = result[i] != 0 ? result[i] : c;
+        }
+    }
+    return result;
+}
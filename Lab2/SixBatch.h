@@ -0,0 +1,37 @@
+#ifndef SIX_BATCH_H
+#define SIX_BATCH_H
+
+#include <cstddef>
+#include <vector>
+#include "Six.h"
+
+// Many fixed-width base-6 values in one buffer. Digits are stored
+// position-major: all least significant digits first, then all second
+// digits, and so on, so element-wise loops run over contiguous memory.
+class SixBatch {
+private:
+    size_t _count;
+    size_t _width;
+    std::vector<unsigned char> _digits;
+
+    void checkCompatible(const SixBatch& other) const;
+
+public:
+    SixBatch(size_t count, size_t width);
+    SixBatch(const std::vector<Six>& values, size_t width);
+
+    size_t count() const;
+    size_t width() const;
+
+    void set(size_t index, const Six& value);
+    Six get(size_t index) const;
+    std::vector<Six> toVector() const;
+
+    SixBatch add(const SixBatch& other) const;
+    SixBatch subtract(const SixBatch& other) const;
+
+    // -1, 0 or 1 per element, like comparing a[i] with b[i].
+    std::vector<signed char> compare(const SixBatch& other) const;
+};
+
+#endif
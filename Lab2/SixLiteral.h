@@ -0,0 +1,111 @@
+#ifndef SIX_LITERAL_H
+#define SIX_LITERAL_H
+
+#include <cstddef>
+#include <stdexcept>
+
+// Fixed-capacity base-6 value usable in constant expressions.
+// Invalid input throws, which turns into a compile error when the
+// value is required to be a constant (e.g. a constexpr variable).
+class SixLiteral {
+public:
+    enum : size_t { capacity = 64 };
+
+private:
+    size_t _size;
+    unsigned char _array[capacity];
+
+public:
+    constexpr SixLiteral() : _size(1), _array{} {}
+
+    constexpr SixLiteral(const char* t, size_t n) : _size(n), _array{} {
+        if (n == 0) {
+            throw std::invalid_argument("String cannot be empty");
+        }
+        if (n > capacity) {
+            throw std::length_error("Too many digits for a base-6 literal");
+        }
+        for (size_t i = 0; i < n; ++i) {
+            char c = t[n - 1 - i];
+            if (c < '0' || c > '5') {
+                throw std::invalid_argument("Invalid digit for base-6 number");
+            }
+            _array[i] = static_cast<unsigned char>(c - '0');
+        }
+        while (_size > 1 && _array[_size - 1] == 0) {
+            --_size;
+        }
+    }
+
+    constexpr size_t size() const {
+        return _size;
+    }
+
+    constexpr unsigned char digit(size_t i) const {
+        return i < _size ? _array[i] : 0;
+    }
+
+    constexpr SixLiteral add(const SixLiteral& other) const {
+        SixLiteral result;
+        size_t maxSize = _size > other._size ? _size : other._size;
+        unsigned char carry = 0;
+        size_t i = 0;
+        for (; i < maxSize || carry; ++i) {
+            if (i == capacity) {
+                throw std::overflow_error("Base-6 literal overflow");
+            }
+            unsigned char sum = carry + digit(i) + other.digit(i);
+            result._array[i] = sum % 6;
+            carry = sum / 6;
+        }
+        result._size = i;
+        return result;
+    }
+
+    constexpr SixLiteral subtract(const SixLiteral& other) const {
+        if (lessThan(other)) {
+            throw std::underflow_error("Subtraction would result in negative number");
+        }
+        SixLiteral result(*this);
+        unsigned char borrow = 0;
+        for (size_t i = 0; i < result._size; ++i) {
+            int diff = result._array[i] - borrow - other.digit(i);
+            borrow = diff < 0 ? 1 : 0;
+            result._array[i] = static_cast<unsigned char>(diff < 0 ? diff + 6 : diff);
+        }
+        while (result._size > 1 && result._array[result._size - 1] == 0) {
+            --result._size;
+        }
+        return result;
+    }
+
+    constexpr bool equals(const SixLiteral& other) const {
+        if (_size != other._size) return false;
+        for (size_t i = 0; i < _size; ++i) {
+            if (_array[i] != other._array[i]) return false;
+        }
+        return true;
+    }
+
+    constexpr bool greaterThan(const SixLiteral& other) const {
+        if (_size != other._size) {
+            return _size > other._size;
+        }
+        for (size_t i = _size; i-- > 0;) {
+            if (_array[i] != other._array[i]) {
+                return _array[i] > other._array[i];
+            }
+        }
+        return false;
+    }
+
+    constexpr bool lessThan(const SixLiteral& other) const {
+        return !equals(other) && !greaterThan(other);
+    }
+};
+
+constexpr SixLiteral operator"" _six(const char* t, size_t n) {
+    return SixLiteral(t, n);
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "SixMod.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+size_t windowFor(size_t bits) {
+    if (bits > 256) return 5;
+    if (bits > 64) return 4;
+    if (bits > 16) return 3;
+    return 1;
+}
+
+// Left-to-right sliding-window exponentiation over the binary digits of
+// the exponent, using only odd powers of the base in the table.
+template <typename Mul>
+Six slidingWindowPow(const Six& base, const std::vector<unsigned char>& bits, Mul mul) {
+    Six result("1"_six);
+    if (bits.empty()) return result;
+
+    size_t window = windowFor(bits.size());
+    std::vector<Six> odd(size_t(1) << (window - 1));
+    odd[0] = base;
+    if (odd.size() > 1) {
+        Six square = mul(base, base);
+        for (size_t i = 1; i < odd.size(); ++i) {
+            odd[i] = mul(odd[i - 1], square);
+        }
+    }
+
+    bool started = false;
+    size_t i = bits.size();
+    while (i > 0) {
+        if (bits[i - 1] == 0) {
+            if (started) result = mul(result, result);
+            --i;
+            continue;
+        }
+
+        size_t low = i > window ? i - window : 0;
+        while (bits[low] == 0) ++low;
+
+        size_t value = 0;
+        for (size_t j = i; j-- > low;) {
+            value = (value << 1) | bits[j];
+            if (started) result = mul(result, result);
+        }
+        result = started ? mul(result, odd[value >> 1]) : odd[value >> 1];
+        started = true;
+        i = low;
+    }
+    return result;
+}
+
+}
+
+SixModContext::SixModContext(const Six& modulus) : _mod(modulus), _k(modulus._size), _mu() {
+    if (modulus.equals(Six())) {
+        throw std::invalid_argument("Modulus cannot be zero");
+    }
+    Six unused;
+    _mu = divide(powerOfSix(2 * _k), _mod, unused);
+}
+
+const Six& SixModContext::modulus() const {
+    return _mod;
+}
+
+Six SixModContext::shiftDown(const Six& x, size_t digits) {
+    if (digits >= x._size) return Six();
+    Six result(x._size - digits, 0);
+    std::copy(x._array + digits, x._array + x._size, result._array);
+    result.removeLeadingZeros();
+    return result;
+}
+
+Six SixModContext::powerOfSix(size_t exponent) {
+    Six result(exponent + 1, 0);
+    result._array[exponent] = 1;
+    return result;
+}
+
+Six SixModContext::divide(const Six& x, const Six& m, Six& remainder) {
+    Six q(x._size, 0);
+    Six r;
+    for (size_t i = x._size; i-- > 0;) {
+        if (r._size == 1 && r._array[0] == 0) {
+            r._array[0] = x._array[i];
+        } else {
+            Six shifted(r._size + 1, 0);
+            std::copy(r._array, r._array + r._size, shifted._array + 1);
+            shifted._array[0] = x._array[i];
+            r = std::move(shifted);
+        }
+
+        unsigned char d = 0;
+        while (!r.lessThan(m)) {
+            r = r.subtract(m);
+            ++d;
+        }
+        q._array[i] = d;
+    }
+    q.removeLeadingZeros();
+    remainder = std::move(r);
+    return q;
+}
+
+// Barrett: q = floor(floor(x / 6^(k-1)) * mu / 6^(k+1)) never exceeds the
+// true quotient by construction and falls short of it by at most two.
+Six SixModContext::reduce(const Six& x) const {
+    if (x.lessThan(_mod)) return x;
+    if (x._size > 2 * _k) {
+        Six r;
+        divide(x, _mod, r);
+        return r;
+    }
+
+    Six q = shiftDown(shiftDown(x, _k - 1).multiply(_mu), _k + 1);
+    Six r = x.subtract(q.multiply(_mod));
+    while (!r.lessThan(_mod)) {
+        r = r.subtract(_mod);
+    }
+    return r;
+}
+
+Six SixModContext::multiply(const Six& a, const Six& b) const {
+    return reduce(reduce(a).multiply(reduce(b)));
+}
+
+Six SixModContext::pow(const Six& base, const Six& exp) const {
+    if (_k == 1 && _mod._array[0] == 1) return Six();
+    Six b = reduce(base);
+    return slidingWindowPow(b, toBits(exp), [this](const Six& x, const Six& y) {
+        return reduce(x.multiply(y));
+    });
+}
+
+std::vector<unsigned char> SixModContext::toBits(const Six& value) {
+    std::vector<unsigned char> digits(value._array, value._array + value._size);
+    std::vector<unsigned char> bits;
+    size_t top = digits.size();
+    while (top > 0 && digits[top - 1] == 0) --top;
+
+    while (top > 0) {
+        unsigned char rem = 0;
+        for (size_t i = top; i-- > 0;) {
+            unsigned char cur = rem * 6 + digits[i];
+            digits[i] = cur / 2;
+            rem = cur % 2;
+        }
+        bits.push_back(rem);
+        while (top > 0 && digits[top - 1] == 0) --top;
+    }
+    return bits;
+}
+
+Six pow(const Six& base, const Six& exp) {
+    return slidingWindowPow(base, SixModContext::toBits(exp), [](const Six& x, const Six& y) {
+        return x.multiply(y);
+    });
+}
+
+Six powmod(const Six& base, const Six& exp, const Six& mod) {
+    return SixModContext(mod).pow(base, exp);
+}
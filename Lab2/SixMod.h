@@ -0,0 +1,36 @@
+#ifndef SIX_MOD_H
+#define SIX_MOD_H
+
+#include <cstddef>
+#include <vector>
+#include "Six.h"
+
+// Barrett reduction for a fixed modulus. The reciprocal is computed once
+// in the constructor, after which reduce/multiply/pow need no division.
+class SixModContext {
+private:
+    Six _mod;
+    size_t _k;
+    Six _mu;
+
+    static Six shiftDown(const Six& x, size_t digits);
+    static Six powerOfSix(size_t exponent);
+    static Six divide(const Six& x, const Six& m, Six& remainder);
+
+public:
+    explicit SixModContext(const Six& modulus);
+
+    const Six& modulus() const;
+
+    Six reduce(const Six& x) const;
+    Six multiply(const Six& a, const Six& b) const;
+    Six pow(const Six& base, const Six& exp) const;
+
+    // Exponent bits, least significant first; empty for zero.
+    static std::vector<unsigned char> toBits(const Six& value);
+};
+
+Six pow(const Six& base, const Six& exp);
+Six powmod(const Six& base, const Six& exp, const Six& mod);
+
+#endif
@@ -0,0 +1,297 @@
+#include "SixSerialize.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kMagic[4] = {'S', 'I', 'X', '6'};
+const size_t kHeaderSize = sizeof(kMagic) + 8;
+const size_t kChunkSize = 1 << 16;
+
+// Written so that counts near SIZE_MAX taken from a header cannot wrap.
+size_t packedSize(size_t digits) {
+    return digits / 3 + (digits % 3 != 0);
+}
+
+// Rejects a header count that needs more packed bytes than are there.
+void checkAvailable(size_t digits, size_t available) {
+    if (available < packedSize(digits)) {
+        throw std::runtime_error("Truncated base-6 binary data");
+    }
+}
+
+void validatePacked(const unsigned char* packed, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        if (packed[i] >= 216) {
+            throw std::runtime_error("Corrupted base-6 binary data");
+        }
+    }
+}
+
+// Bytes left in a seekable stream, or SIZE_MAX when it cannot tell.
+size_t remainingBytes(std::istream& in) {
+    std::streampos here = in.tellg();
+    if (here == std::streampos(-1)) {
+        in.clear();
+        return SIZE_MAX;
+    }
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.clear();
+    in.seekg(here);
+    if (end == std::streampos(-1) || end < here) {
+        return SIZE_MAX;
+    }
+    return static_cast<size_t>(end - here);
+}
+
+void encodeHeader(size_t digits, unsigned char* header) {
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    unsigned long long n = digits;
+    for (size_t i = 0; i < 8; ++i) {
+        header[sizeof(kMagic) + i] = static_cast<unsigned char>(n >> (8 * i));
+    }
+}
+
+size_t decodeHeader(const unsigned char* header) {
+    if (std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a base-6 binary file");
+    }
+    unsigned long long n = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        n |= static_cast<unsigned long long>(header[sizeof(kMagic) + i]) << (8 * i);
+    }
+    if (n == 0) {
+        throw std::runtime_error("Base-6 binary file has no digits");
+    }
+    return static_cast<size_t>(n);
+}
+
+void unpack(const unsigned char* packed, size_t digits, unsigned char* out) {
+    for (size_t i = 0; i < digits; i += 3) {
+        unsigned char b = packed[i / 3];
+        if (b >= 216) {
+            throw std::runtime_error("Corrupted base-6 binary data");
+        }
+        out[i] = b % 6;
+        if (i + 1 < digits) out[i + 1] = (b / 6) % 6;
+        if (i + 2 < digits) out[i + 2] = b / 36;
+    }
+}
+
+}
+
+void writeBinary(const Six& value, std::ostream& out) {
+    unsigned char header[kHeaderSize];
+    encodeHeader(value._size, header);
+    out.write(reinterpret_cast<const char*>(header), kHeaderSize);
+
+    unsigned char buffer[kChunkSize];
+    size_t used = 0;
+    for (size_t i = 0; i < value._size; i += 3) {
+        unsigned char b = value._array[i];
+        if (i + 1 < value._size) b += 6 * value._array[i + 1];
+        if (i + 2 < value._size) b += 36 * value._array[i + 2];
+        buffer[used++] = b;
+        if (used == kChunkSize) {
+            out.write(reinterpret_cast<const char*>(buffer), used);
+            used = 0;
+        }
+    }
+    out.write(reinterpret_cast<const char*>(buffer), used);
+
+    if (!out) {
+        throw std::runtime_error("Failed to write base-6 binary data");
+    }
+}
+
+Six readBinary(std::istream& in) {
+    unsigned char header[kHeaderSize];
+    if (!in.read(reinterpret_cast<char*>(header), kHeaderSize)) {
+        throw std::runtime_error("Truncated base-6 binary header");
+    }
+    size_t digits = decodeHeader(header);
+    checkAvailable(digits, remainingBytes(in));
+
+    // The count comes from the file, so nothing is allocated for it up
+    // front: the packed bytes are collected as they arrive and the digit
+    // buffer is only created once the stream has proven to hold them all.
+    std::vector<unsigned char> packed;
+    size_t remaining = packedSize(digits);
+    while (remaining > 0) {
+        size_t n = std::min(remaining, kChunkSize);
+        size_t used = packed.size();
+        packed.resize(used + n);
+        if (!in.read(reinterpret_cast<char*>(packed.data() + used), n)) {
+            throw std::runtime_error("Truncated base-6 binary data");
+        }
+        remaining -= n;
+    }
+
+    Six result(digits, 0);
+    unpack(packed.data(), digits, result._array);
+    result.removeLeadingZeros();
+    return result;
+}
+
+SixView::SixView(const unsigned char* packed, size_t digits) : _packed(packed), _size(digits) {
+    if (digits == 0) {
+        throw std::invalid_argument("Size cannot be zero");
+    }
+    validatePacked(packed, packedSize(digits));
+}
+
+SixView::SixView(const unsigned char* packed, size_t digits, Trusted) : _packed(packed), _size(digits) {}
+
+size_t SixView::size() const {
+    return _size;
+}
+
+unsigned char SixView::digit(size_t i) const {
+    if (i >= _size) {
+        throw std::out_of_range("Digit index out of range");
+    }
+    unsigned char b = _packed[i / 3];
+    switch (i % 3) {
+        case 0: return b % 6;
+        case 1: return (b / 6) % 6;
+        default: return b / 36;
+    }
+}
+
+std::string SixView::toString() const {
+    return toSix().toString();
+}
+
+Six SixView::toSix() const {
+    Six result(_size, 0);
+    unpack(_packed, _size, result._array);
+    result.removeLeadingZeros();
+    return result;
+}
+
+// Packed bytes are base-216 digits, so byte order matches numeric order
+// once both sides have the same number of base-6 digits.
+bool SixView::equals(const SixView& other) const {
+    return _size == other._size &&
+           std::memcmp(_packed, other._packed, packedSize(_size)) == 0;
+}
+
+bool SixView::greaterThan(const SixView& other) const {
+    if (_size != other._size) {
+        return _size > other._size;
+    }
+    for (size_t i = packedSize(_size); i-- > 0;) {
+        if (_packed[i] != other._packed[i]) {
+            return _packed[i] > other._packed[i];
+        }
+    }
+    return false;
+}
+
+bool SixView::lessThan(const SixView& other) const {
+    return !equals(other) && !greaterThan(other);
+}
+
+MappedSix::MappedSix(const std::string& path) : _data(nullptr), _length(0), _digits(0) {
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    _buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _length = _buffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    _length = static_cast<size_t>(st.st_size);
+    if (_length > 0) {
+        void* p = ::mmap(nullptr, _length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        _data = static_cast<const unsigned char*>(p);
+    }
+    ::close(fd);
+#endif
+
+    try {
+        if (_length < kHeaderSize) {
+            throw std::runtime_error("Truncated base-6 binary header");
+        }
+        _digits = decodeHeader(_data);
+        checkAvailable(_digits, _length - kHeaderSize);
+        validatePacked(_data + kHeaderSize, packedSize(_digits));
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+MappedSix::MappedSix(MappedSix&& other) noexcept
+    : _data(other._data), _length(other._length), _digits(other._digits)
+#ifdef _WIN32
+    , _buffer(std::move(other._buffer))
+#endif
+{
+    other._data = nullptr;
+    other._length = 0;
+    other._digits = 0;
+}
+
+MappedSix::~MappedSix() noexcept {
+    release();
+}
+
+MappedSix& MappedSix::operator=(MappedSix&& other) noexcept {
+    if (this != &other) {
+        release();
+        _data = other._data;
+        _length = other._length;
+        _digits = other._digits;
+#ifdef _WIN32
+        _buffer = std::move(other._buffer);
+#endif
+        other._data = nullptr;
+        other._length = 0;
+        other._digits = 0;
+    }
+    return *this;
+}
+
+void MappedSix::release() noexcept {
+#ifndef _WIN32
+    if (_data) {
+        ::munmap(const_cast<unsigned char*>(_data), _length);
+    }
+#endif
+    _data = nullptr;
+    _length = 0;
+    _digits = 0;
+}
+
+SixView MappedSix::view() const {
+    return SixView(_data + kHeaderSize, _digits, SixView::Trusted());
+}
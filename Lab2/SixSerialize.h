@@ -0,0 +1,67 @@
+#ifndef SIX_SERIALIZE_H
+#define SIX_SERIALIZE_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "Six.h"
+
+// Binary layout: 4-byte magic "SIX6", digit count as 8-byte little-endian,
+// then ceil(count / 3) bytes. Each byte packs three digits,
+// least significant first: d[3k] + 6 * d[3k + 1] + 36 * d[3k + 2].
+void writeBinary(const Six& value, std::ostream& out);
+Six readBinary(std::istream& in);
+
+// Read-only view over packed digits owned by someone else.
+class SixView {
+private:
+    const unsigned char* _packed;
+    size_t _size;
+
+    // Skips the digit scan, for packed data its owner already validated.
+    struct Trusted {};
+    SixView(const unsigned char* packed, size_t digits, Trusted);
+
+    friend class MappedSix;
+
+public:
+    SixView(const unsigned char* packed, size_t digits);
+
+    size_t size() const;
+    unsigned char digit(size_t i) const;
+    std::string toString() const;
+    Six toSix() const;
+
+    bool equals(const SixView& other) const;
+    bool greaterThan(const SixView& other) const;
+    bool lessThan(const SixView& other) const;
+};
+
+// Maps a file written by writeBinary and exposes it as a SixView
+// without copying the digits. The file is validated once on opening,
+// so view() is O(1).
+class MappedSix {
+private:
+    const unsigned char* _data;
+    size_t _length;
+    size_t _digits;
+#ifdef _WIN32
+    std::vector<unsigned char> _buffer;
+#endif
+
+    void release() noexcept;
+
+public:
+    explicit MappedSix(const std::string& path);
+    MappedSix(const MappedSix& other) = delete;
+    MappedSix(MappedSix&& other) noexcept;
+    ~MappedSix() noexcept;
+
+    MappedSix& operator=(const MappedSix& other) = delete;
+    MappedSix& operator=(MappedSix&& other) noexcept;
+
+    SixView view() const;
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "Six.h"
+
+// Allocation counting hook: every global new/new[] in this program bumps
+// the counters, so each benchmark can report allocator pressure per op.
+namespace {
+
+std::atomic<size_t> g_allocations(0);
+std::atomic<size_t> g_bytes(0);
+
+void* countedAlloc(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+struct AllocSnapshot {
+    size_t allocations;
+    size_t bytes;
+
+    static AllocSnapshot now() {
+        AllocSnapshot s;
+        s.allocations = g_allocations.load(std::memory_order_relaxed);
+        s.bytes = g_bytes.load(std::memory_order_relaxed);
+        return s;
+    }
+};
+
+}
+
+void* operator new(size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+volatile size_t g_sink = 0;
+
+std::string makeDigits(size_t n, unsigned seed) {
+    std::string s(n, '0');
+    unsigned x = seed;
+    for (size_t i = 0; i < n; ++i) {
+        x = x * 1103515245u + 12345u;
+        s[i] = static_cast<char>('0' + (x >> 16) % 6);
+    }
+    s[0] = '1' + seed % 5;
+    return s;
+}
+
+// Repeats op until at least minSeconds have passed (and at least once),
+// then reports time, digit throughput and allocations per call.
+template <typename Op>
+void run(const char* name, size_t digits, Op op) {
+    const double minSeconds = 0.05;
+    size_t iterations = 0;
+    AllocSnapshot before = AllocSnapshot::now();
+    Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    do {
+        op();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    AllocSnapshot after = AllocSnapshot::now();
+
+    double perOp = elapsed / iterations;
+    std::printf("%-12s %10zu %14.1f %12.1f %10.2f %14.1f\n",
+                name, digits, perOp * 1e9, digits / perOp / 1e6,
+                double(after.allocations - before.allocations) / iterations,
+                double(after.bytes - before.bytes) / iterations);
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t maxDigits = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000000;
+
+    std::printf("%-12s %10s %14s %12s %10s %14s\n",
+                "operation", "digits", "ns/op", "Mdigit/s", "allocs/op", "bytes/op");
+
+    for (size_t n = 1; n <= maxDigits; n *= 10) {
+        std::string s1 = makeDigits(n, 1);
+        std::string s2 = makeDigits(n, 2);
+        Six a(s1);
+        Six b(s2);
+        Six big = a.greaterThan(b) ? a : b;
+        Six small = a.greaterThan(b) ? b : a;
+        Six same(big);
+
+        run("construct", n, [&] { Six x(s1); g_sink += x.size(); });
+        run("toString", n, [&] { g_sink += a.toString().size(); });
+        run("add", n, [&] { g_sink += a.add(b).size(); });
+        run("subtract", n, [&] { g_sink += big.subtract(small).size(); });
+        run("equals", n, [&] { g_sink += big.equals(same); });
+        run("greaterThan", n, [&] { g_sink += big.greaterThan(same); });
+        run("lessThan", n, [&] { g_sink += small.lessThan(big); });
+
+        if (n > maxDigits / 10) break;
+    }
+    return 0;
+}
@@ -1,5 +1,14 @@
 #include <gtest/gtest.h>
+#include <limits>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include "Six.h"
+#include "SixSerialize.h"
+#include "SixBatch.h"
+#include "SixMod.h"
 
 TEST(SixTest, DefaultConstructor) {
     Six num;
@@ -197,6 +206,286 @@ TEST(SixTest, MoveSemantics) {
     EXPECT_EQ(moved.toString(), "12345");
 }
 
+TEST(SixLiteralTest, CompileTimeConstants) {
+    constexpr SixLiteral a = "12345"_six;
+    constexpr SixLiteral b = "00054321"_six;
+    static_assert(a.size() == 5, "leading digits kept");
+    static_assert(b.size() == 5, "leading zeros removed");
+    static_assert(a.add(b).equals("111110"_six), "compile-time addition");
+    static_assert(b.subtract(a).equals("41532"_six), "compile-time subtraction");
+    static_assert(b.greaterThan(a) && a.lessThan(b), "compile-time comparison");
+
+    EXPECT_EQ(Six(a).toString(), "12345");
+    EXPECT_EQ(Six(b).toString(), "54321");
+}
+
+TEST(SixLiteralTest, ConversionMatchesStringConstructor) {
+    Six fromLiteral = "555"_six;
+    EXPECT_TRUE(fromLiteral.equals(Six("555")));
+    EXPECT_EQ(Six("0"_six).toString(), "0");
+}
+
+TEST(SixLiteralTest, RuntimeErrors) {
+    EXPECT_THROW(SixLiteral("126", 3), std::invalid_argument);
+    EXPECT_THROW(SixLiteral("", 0), std::invalid_argument);
+    EXPECT_THROW("1"_six.subtract("2"_six), std::underflow_error);
+    std::string tooLong(SixLiteral::capacity + 1, '1');
+    EXPECT_THROW(SixLiteral(tooLong.c_str(), tooLong.size()), std::length_error);
+}
+
+TEST(SixSerializeTest, RoundTripThroughStream) {
+    const char* values[] = {"0", "5", "10", "12345", "5432101234", "100000000000000"};
+    for (const char* v : values) {
+        std::stringstream ss;
+        writeBinary(Six(v), ss);
+        EXPECT_EQ(ss.str().size(), 12 + (std::string(v).size() + 2) / 3);
+        EXPECT_EQ(readBinary(ss).toString(), v);
+    }
+}
+
+TEST(SixSerializeTest, RejectsBadInput) {
+    std::stringstream garbage("not a number at all");
+    EXPECT_THROW(readBinary(garbage), std::runtime_error);
+
+    std::stringstream ss;
+    writeBinary(Six("123451234512345"), ss);
+    std::string truncated = ss.str().substr(0, ss.str().size() - 1);
+    std::stringstream cut(truncated);
+    EXPECT_THROW(readBinary(cut), std::runtime_error);
+
+    // A header claiming far more digits than the stream holds must fail
+    // on the missing data, not on allocating for the claimed count.
+    std::string huge = ss.str();
+    for (size_t i = 4; i < 12; ++i) huge[i] = static_cast<char>(0x7f);
+    std::stringstream lying(huge);
+    EXPECT_THROW(readBinary(lying), std::runtime_error);
+
+    // A count of 2^64 - 2 must not wrap the packed size to zero.
+    std::string wrapping = std::string("SIX6") + '\xfe' + std::string(7, '\xff');
+    std::stringstream wrapped(wrapping);
+    EXPECT_THROW(readBinary(wrapped), std::runtime_error);
+}
+
+TEST(SixSerializeTest, ViewComparesPackedDigits) {
+    unsigned char a[] = {0 + 6 * 1 + 36 * 2, 3};  // 3210
+    unsigned char b[] = {5 + 6 * 1 + 36 * 2, 3};  // 3215
+    SixView va(a, 4);
+    SixView vb(b, 4);
+    EXPECT_EQ(va.toString(), "3210");
+    EXPECT_EQ(va.digit(3), 3);
+    EXPECT_TRUE(vb.greaterThan(va));
+    EXPECT_TRUE(va.lessThan(vb));
+    EXPECT_TRUE(va.equals(SixView(a, 4)));
+    EXPECT_THROW(va.digit(4), std::out_of_range);
+
+    unsigned char bad[] = {216, 3};
+    EXPECT_THROW(SixView(bad, 4), std::runtime_error);
+}
+
+TEST(SixSerializeTest, MappedFileView) {
+    std::string path = ::testing::TempDir() + "six_mapped.bin";
+    Six value("4321054321043210");
+    {
+        std::ofstream out(path, std::ios::binary);
+        writeBinary(value, out);
+    }
+
+    MappedSix mapped(path);
+    SixView view = mapped.view();
+    EXPECT_EQ(view.size(), value.size());
+    EXPECT_EQ(view.toString(), value.toString());
+    EXPECT_TRUE(view.toSix().equals(value));
+
+    MappedSix moved(std::move(mapped));
+    EXPECT_EQ(moved.view().toString(), value.toString());
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "SIX6" << '\xfe' << std::string(7, '\xff');
+    }
+    EXPECT_THROW(MappedSix{path}, std::runtime_error);
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "SIX6" << '\x02' << std::string(7, '\0') << '\xff';
+    }
+    EXPECT_THROW(MappedSix{path}, std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(SixStreamTest, ParsesWholeStream) {
+    std::istringstream in("  0001234505\n");
+    Six num(in);
+    EXPECT_EQ(num.toString(), "1234505");
+    EXPECT_TRUE(in.eof());
+    EXPECT_FALSE(in.fail());
+
+    std::istringstream zeros("0000");
+    EXPECT_EQ(Six(zeros).toString(), "0");
+}
+
+TEST(SixStreamTest, MatchesStringConstructorAcrossChunks) {
+    std::string digits;
+    for (size_t i = 0; i < 200000; ++i) {
+        digits += static_cast<char>('0' + (i * 7 + 1) % 6);
+    }
+    std::istringstream in(digits);
+    Six streamed(in);
+    EXPECT_TRUE(streamed.equals(Six(digits)));
+    EXPECT_EQ(streamed.size(), digits.size());
+}
+
+TEST(SixStreamTest, ReadsNonSeekableStream) {
+    // A buffer that only supports reading forward, like a pipe.
+    class ForwardOnlyBuf : public std::streambuf {
+    public:
+        explicit ForwardOnlyBuf(std::string text) : _text(std::move(text)) {
+            setg(&_text[0], &_text[0], &_text[0] + _text.size());
+        }
+
+    private:
+        std::string _text;
+    };
+
+    std::string digits = "00" + std::string(100000, '4') + "3\n";
+    ForwardOnlyBuf buf(digits);
+    std::istream in(&buf);
+    Six num(in);
+    EXPECT_EQ(num.size(), 100001);
+    EXPECT_EQ(num.toString(), digits.substr(2, 100001));
+}
+
+TEST(SixStreamTest, RejectsInvalidInput) {
+    std::istringstream empty("   ");
+    EXPECT_THROW(Six{empty}, std::invalid_argument);
+    std::istringstream badDigit("12365");
+    EXPECT_THROW(Six{badDigit}, std::invalid_argument);
+    std::istringstream twoNumbers("123 45");
+    EXPECT_THROW(Six{twoNumbers}, std::invalid_argument);
+}
+
+TEST(SixBatchTest, EmptyAndOversizedBatches) {
+    SixBatch empty(0, 4);
+    EXPECT_EQ(empty.add(empty).count(), 0);
+    EXPECT_EQ(empty.subtract(empty).count(), 0);
+    EXPECT_TRUE(empty.compare(empty).empty());
+    EXPECT_THROW(SixBatch(std::numeric_limits<size_t>::max() / 2, 3), std::length_error);
+    EXPECT_THROW(SixBatch(3, 0), std::invalid_argument);
+}
+
+TEST(SixBatchTest, RoundTripValues) {
+    std::vector<Six> values = {Six("0"), Six("5"), Six("12345"), Six("555555")};
+    SixBatch batch(values, 6);
+    EXPECT_EQ(batch.count(), 4);
+    EXPECT_EQ(batch.width(), 6);
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_TRUE(batch.get(i).equals(values[i]));
+    }
+    EXPECT_EQ(batch.toVector()[2].toString(), "12345");
+    EXPECT_THROW(batch.set(0, Six("1000000")), std::overflow_error);
+    EXPECT_THROW(batch.get(4), std::out_of_range);
+}
+
+TEST(SixBatchTest, ElementWiseArithmetic) {
+    SixBatch a({Six("123"), Six("5"), Six("555")}, 4);
+    SixBatch b({Six("321"), Six("1"), Six("1")}, 4);
+
+    SixBatch sum = a.add(b);
+    EXPECT_EQ(sum.get(0).toString(), "444");
+    EXPECT_EQ(sum.get(1).toString(), "10");
+    EXPECT_EQ(sum.get(2).toString(), "1000");
+
+    SixBatch diff = sum.subtract(b);
+    for (size_t i = 0; i < a.count(); ++i) {
+        EXPECT_TRUE(diff.get(i).equals(a.get(i)));
+    }
+
+    EXPECT_THROW(b.subtract(a), std::underflow_error);
+    EXPECT_THROW(a.add(SixBatch(3, 5)), std::invalid_argument);
+    SixBatch full({Six("5555")}, 4);
+    EXPECT_THROW(full.add(full), std::overflow_error);
+}
+
+TEST(SixBatchTest, ElementWiseCompare) {
+    SixBatch a({Six("123"), Six("50"), Six("444")}, 3);
+    SixBatch b({Six("321"), Six("5"), Six("444")}, 3);
+    std::vector<signed char> cmp = a.compare(b);
+    EXPECT_EQ(cmp[0], -1);
+    EXPECT_EQ(cmp[1], 1);
+    EXPECT_EQ(cmp[2], 0);
+}
+
+TEST(SixModTest, Multiply) {
+    EXPECT_EQ(Six("12").multiply(Six("5")).toString(), "104");
+    EXPECT_EQ(Six("555").multiply(Six("555")).toString(), "554001");
+    EXPECT_EQ(Six("12345").multiply(Six()).toString(), "0");
+}
+
+TEST(SixModTest, Pow) {
+    EXPECT_EQ(pow(Six("3"), Six("244")).toString(), "14313423522011412241035544440223523234135534040541211210520213");
+    EXPECT_EQ(pow(Six("12345"), Six("0")).toString(), "1");
+    EXPECT_EQ(pow(Six("0"), Six("0")).toString(), "1");
+    EXPECT_EQ(pow(Six("2"), Six("10")).toString(), "144");
+}
+
+TEST(SixModTest, PowmodLargeOperands) {
+    Six base("3102302152204302254411104044550530402553524513041455535134540305113505315411524255052142140444423324330342253210253354550303141013300104443224114523134422252142000542454135515113252130350433303034204342550110342001450351445451514104");
+    Six exp("4532551551055024011104230042134405511201124055522300140253134542102405034304000311300122153355513011103230210205055");
+    Six mod("35424401504534054514355443553423413114402132200332310304133311415411225224025255051545321530332232104244014141300131002323412303255550501142532142143305404304042453244410053445535343114031240252150224125514045451053314124451320554302200045");
+    EXPECT_EQ(powmod(base, exp, mod).toString(),
+              "22345321133130032525551000244055500215424540550252353300455003354151154032154522014230401311345211334321003402200215210035542431302513530112433451422531450105434452440124024020521135014530143210241430441100542035030505315203210312242153302");
+}
+
+TEST(SixModTest, ContextIsReusable) {
+    SixModContext ctx(Six("253040130434434333320331"));  // 2^61 - 1, prime
+    Six pMinusOne = ctx.modulus().subtract(Six("1"));
+    const char* bases[] = {"2", "3", "5433", "1234512345123451234512345"};
+    for (const char* b : bases) {
+        EXPECT_EQ(ctx.pow(Six(b), pMinusOne).toString(), "1");
+    }
+    EXPECT_EQ(ctx.reduce(ctx.modulus()).toString(), "0");
+    EXPECT_EQ(ctx.multiply(Six("2"), Six("3")).toString(), "10");
+}
+
+TEST(SixModTest, EdgeModuli) {
+    EXPECT_THROW(SixModContext{Six("0")}, std::invalid_argument);
+    EXPECT_EQ(powmod(Six("12345"), Six("12"), Six("1")).toString(), "0");
+    EXPECT_EQ(powmod(Six("12345"), Six("0"), Six("4")).toString(), "1");
+}
+
+TEST(SixHashTest, EqualValuesHashEqual) {
+    std::string digits(1000, '4');
+    digits[0] = '1';
+    Six a(digits);
+    Six b("000" + digits);
+    EXPECT_TRUE(a.equals(b));
+    EXPECT_EQ(a.hash(), b.hash());
+    EXPECT_EQ(std::hash<Six>()(a), a.hash());
+
+    digits[999] = '5';
+    EXPECT_NE(a.hash(), Six(digits).hash());
+    EXPECT_NE(Six("1").hash(), Six("10").hash());
+}
+
+TEST(SixHashTest, UnorderedContainers) {
+    std::unordered_set<Six> seen;
+    for (int i = 0; i < 3; ++i) {
+        seen.insert(Six("12345"));
+        seen.insert(Six("0"));
+        seen.insert(Six("5").add(Six("1")));
+    }
+    EXPECT_EQ(seen.size(), 3);
+    EXPECT_EQ(seen.count(Six("10")), 1);
+    EXPECT_EQ(seen.count(Six("11")), 0);
+
+    std::unordered_map<HashedSix, int> counts;
+    counts[HashedSix(Six("555"))] += 1;
+    counts[HashedSix(Six("555"))] += 1;
+    counts[HashedSix(Six("554"))] += 1;
+    EXPECT_EQ(counts.size(), 2);
+    EXPECT_EQ(counts[HashedSix(Six("555"))], 2);
+    EXPECT_EQ(HashedSix(Six("555")).hash(), Six("555").hash());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,70 @@
+#ifndef AFFINE_H
+#define AFFINE_H
+
+#include <cmath>
+#include "figure.h"
+
+// 2x3 affine map: x' = a*x + b*y + tx, y' = c*x + d*y + ty.
+struct Affine {
+    double a = 1, b = 0, tx = 0;
+    double c = 0, d = 1, ty = 0;
+
+    static Affine translation(double dx, double dy) {
+        return Affine{1, 0, dx, 0, 1, dy};
+    }
+
+    static Affine scaling(double sx, double sy) {
+        return Affine{sx, 0, 0, 0, sy, 0};
+    }
+
+    static Affine scaling(double s) {
+        return scaling(s, s);
+    }
+
+    // Counter-clockwise rotation by angle radians about the origin.
+    static Affine rotation(double angle) {
+        double cs = std::cos(angle), sn = std::sin(angle);
+        return Affine{cs, -sn, 0, sn, cs, 0};
+    }
+
+    static Affine rotation(double angle, const Point& pivot) {
+        return translation(pivot.x, pivot.y) * rotation(angle) * translation(-pivot.x, -pivot.y);
+    }
+
+    // (p * q)(x) = p(q(x)): q is applied first.
+    friend Affine operator*(const Affine& p, const Affine& q) {
+        return Affine{p.a * q.a + p.b * q.c, p.a * q.b + p.b * q.d, p.a * q.tx + p.b * q.ty + p.tx,
+                      p.c * q.a + p.d * q.c, p.c * q.b + p.d * q.d, p.c * q.tx + p.d * q.ty + p.ty};
+    }
+
+    double determinant() const {
+        return a * d - b * c;
+    }
+
+    // Rotation, reflection and uniform scaling, plus any translation:
+    // shapes keep their angles and every area scales by |determinant()|.
+    bool is_similarity() const {
+        double tolerance = 1e-12 * (std::abs(a) + std::abs(b) + std::abs(c) + std::abs(d));
+        bool rotation = std::abs(a - d) <= tolerance && std::abs(b + c) <= tolerance;
+        bool reflection = std::abs(a + d) <= tolerance && std::abs(b - c) <= tolerance;
+        return rotation || reflection;
+    }
+
+    bool is_axis_aligned() const {
+        return b == 0 && c == 0;
+    }
+
+    Point apply(const Point& p) const {
+        return Point(a * p.x + b * p.y + tx, c * p.x + d * p.y + ty);
+    }
+
+    void apply(Point* points, size_t n) const {
+        for (size_t i = 0; i < n; ++i) {
+            double x = points[i].x, y = points[i].y;
+            points[i].x = a * x + b * y + tx;
+            points[i].y = c * x + d * y + ty;
+        }
+    }
+};
+
+#endif
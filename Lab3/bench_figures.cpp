@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "figure_array.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include "hexagon.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+template <typename Op>
+double seconds(Op op) {
+    Clock::time_point start = Clock::now();
+    op();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+FigureArray make_figures(size_t n) {
+    FigureArray array;
+    for (size_t i = 0; i < n; ++i) {
+        Point c(double(i % 1000), double(i / 1000));
+        switch (i % 3) {
+            case 0: array.add(std::make_shared<Rhombus>(c, 1 + i % 7, 2 + i % 5)); break;
+            case 1: array.add(std::make_shared<Pentagon>(c, 0.5 + i % 3)); break;
+            default: array.add(std::make_shared<Hexagon>(c, 0.25 + i % 4)); break;
+        }
+    }
+    return array;
+}
+
+// Counts bytes instead of writing them, so print_all measures formatting.
+class DiscardSink : public OutputSink {
+public:
+    size_t bytes = 0;
+    void write(const char*, size_t size) override {
+        bytes += size;
+    }
+};
+
+}
+
+// Times the parallel bulk operations on 1..N threads and prints the
+// speedup relative to one thread.
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    size_t max_threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                  : resolve_thread_count(0);
+
+    FigureArray array = make_figures(n);
+    std::printf("%zu figures\n", array.size());
+    std::printf("%-20s %8s %12s %8s\n", "operation", "threads", "ms", "speedup");
+
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+
+    const char* names[] = {"total_area", "count_if", "transform", "for_each", "print_all"};
+    for (int op = 0; op < 5; ++op) {
+        double base = 0;
+        for (size_t threads : thread_counts) {
+            double sink = 0;
+            double t = seconds([&] {
+                switch (op) {
+                    case 0:
+                        sink = array.parallel_total_area(threads);
+                        break;
+                    case 1:
+                        sink = array.parallel_count_if([](const Figure& f) { return f.area() > 3; }, threads);
+                        break;
+                    case 2:
+                        sink = array.parallel_transform([](const Figure& f) { return f.bounding_box().max.x; }, threads).size();
+                        break;
+                    case 3:
+                        array.parallel_for_each([](Figure& f) { f.center(); }, threads);
+                        break;
+                    default: {
+                        DiscardSink out;
+                        array.print_all(out, threads);
+                        sink = out.bytes;
+                        break;
+                    }
+                }
+            });
+            if (threads == 1) base = t;
+            std::printf("%-20s %8zu %12.2f %8.2f\n", names[op], threads, t * 1e3, base / t);
+            if (sink < 0) std::printf("unexpected\n");
+        }
+    }
+
+    // Sliding window: add at increasing x and remove the oldest handle,
+    // which always touches the bounding box.
+    size_t window = std::min<size_t>(n, 100000);
+    FigureArray churn;
+    std::deque<FigureHandle> live;
+    for (size_t i = 0; i < window; ++i) {
+        live.push_back(churn.add(std::make_shared<Rhombus>(Point(double(i), 0), 1, 1)));
+    }
+    size_t steps = 100000;
+    double t = seconds([&] {
+        for (size_t i = window; i < window + steps; ++i) {
+            live.push_back(churn.add(std::make_shared<Rhombus>(Point(double(i), 0), 1, 1)));
+            churn.remove(live.front());
+            live.pop_front();
+        }
+    });
+    std::printf("%-20s %8d %12.2f %8s  (%.3f us/op, window %zu)\n", "churn", 1, t * 1e3, "-",
+                t * 1e6 / steps, window);
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "collision.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include "parallel.h"
+
+namespace {
+
+void project(const Point* v, size_t n, double ax, double ay, double& lo, double& hi) {
+    lo = std::numeric_limits<double>::infinity();
+    hi = -lo;
+    for (size_t i = 0; i < n; ++i) {
+        double d = v[i].x * ax + v[i].y * ay;
+        lo = std::min(lo, d);
+        hi = std::max(hi, d);
+    }
+}
+
+// True if one of a's edge normals separates the two polygons.
+bool has_separating_axis(const Point* a, size_t na, const Point* b, size_t nb) {
+    for (size_t i = 0; i < na; ++i) {
+        const Point& p = a[i];
+        const Point& q = a[(i + 1) % na];
+        double ax = q.y - p.y;
+        double ay = p.x - q.x;
+        if (ax == 0 && ay == 0) continue;
+
+        double alo, ahi, blo, bhi;
+        project(a, na, ax, ay, alo, ahi);
+        project(b, nb, ax, ay, blo, bhi);
+        if (ahi < blo || bhi < alo) return true;
+    }
+    return false;
+}
+
+bool polygons_intersect(const Point* a, size_t na, const Point* b, size_t nb) {
+    return !has_separating_axis(a, na, b, nb) && !has_separating_axis(b, nb, a, na);
+}
+
+std::vector<Point> vertices_of(const Figure& figure) {
+    std::vector<Point> v(figure.vertex_count());
+    for (size_t i = 0; i < v.size(); ++i) {
+        v[i] = figure.vertex(i);
+    }
+    return v;
+}
+
+}
+
+bool figures_intersect(const Figure& a, const Figure& b) {
+    std::vector<Point> va = vertices_of(a);
+    std::vector<Point> vb = vertices_of(b);
+    return polygons_intersect(va.data(), va.size(), vb.data(), vb.size());
+}
+
+std::vector<std::pair<size_t, size_t>> find_overlaps(const FigureArray& array, size_t threads) {
+    size_t n = array.size();
+
+    // Flatten everything once so the sweep never goes through a virtual call.
+    std::vector<BoundingBox> boxes(n);
+    std::vector<size_t> offsets(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        offsets[i + 1] = offsets[i] + array.at(i).vertex_count();
+    }
+    std::vector<Point> vertices(offsets[n]);
+    for (size_t i = 0; i < n; ++i) {
+        const Figure& figure = array.at(i);
+        boxes[i] = figure.bounding_box();
+        for (size_t v = 0; v < figure.vertex_count(); ++v) {
+            vertices[offsets[i] + v] = figure.vertex(v);
+        }
+    }
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return boxes[a].min.x < boxes[b].min.x;
+    });
+
+    const size_t block = 1024;
+    std::vector<std::vector<std::pair<size_t, size_t>>> found(block_count(n, block));
+    parallel_blocks(n, threads, [&](size_t b, size_t begin, size_t end) {
+        auto& out = found[b];
+        for (size_t p = begin; p < end; ++p) {
+            size_t i = order[p];
+            const BoundingBox& bi = boxes[i];
+            for (size_t q = p + 1; q < n && boxes[order[q]].min.x <= bi.max.x; ++q) {
+                size_t j = order[q];
+                const BoundingBox& bj = boxes[j];
+                if (bj.max.y < bi.min.y || bi.max.y < bj.min.y) continue;
+                if (polygons_intersect(&vertices[offsets[i]], offsets[i + 1] - offsets[i],
+                                       &vertices[offsets[j]], offsets[j + 1] - offsets[j])) {
+                    out.emplace_back(std::min(i, j), std::max(i, j));
+                }
+            }
+        }
+    }, block);
+
+    std::vector<std::pair<size_t, size_t>> result;
+    for (auto& part : found) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
@@ -0,0 +1,19 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <utility>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+
+// Separating-axis test for two convex polygons. Touching counts as
+// overlapping. Non-convex input is treated as its edges' normals allow,
+// which may report overlaps that are not there.
+bool figures_intersect(const Figure& a, const Figure& b);
+
+// All pairs (i, j), i < j, of overlapping figures, sorted. A sweep over
+// bounding boxes sorted by x finds candidate pairs, and the separating-axis
+// test confirms them.
+std::vector<std::pair<size_t, size_t>> find_overlaps(const FigureArray& array, size_t threads = 0);
+
+#endif
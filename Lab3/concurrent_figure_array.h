@@ -0,0 +1,204 @@
+#ifndef CONCURRENT_FIGURE_ARRAY_H
+#define CONCURRENT_FIGURE_ARRAY_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+
+// Append-only figure array for several producer threads. Writers reserve
+// index ranges with one fetch_add (a bulk add gets a contiguous chunk),
+// fill them without locks and then publish them: size() only advances over
+// a prefix of fully written slots, so readers calling size/get/total_area
+// never block and never see a half-written figure.
+//
+// Storage is a list of segments of doubling size that are allocated on
+// first use and never move, so published figures stay where they are.
+class ConcurrentFigureArray {
+private:
+    struct Slot {
+        std::shared_ptr<const Figure> figure;
+        std::atomic<bool> ready{false};
+    };
+
+    static constexpr size_t first_segment_size = 1024;
+    static constexpr size_t max_segments = 40;
+    static constexpr size_t area_shards = 16;
+    static constexpr size_t capacity = first_segment_size * ((size_t(1) << max_segments) - 1);
+
+    struct alignas(64) AreaShard {
+        std::atomic<double> sum{0};
+    };
+
+    std::array<std::atomic<Slot*>, max_segments> segments{};
+    std::atomic<size_t> reserved{0};
+    std::atomic<size_t> published{0};
+    std::array<AreaShard, area_shards> area;
+    std::array<std::atomic<size_t>, figure_type_count> type_counts{};
+
+    static size_t segment_of(size_t index) {
+        return std::bit_width(index / first_segment_size + 1) - 1;
+    }
+
+    static size_t segment_start(size_t segment) {
+        return first_segment_size * ((size_t(1) << segment) - 1);
+    }
+
+    static size_t segment_size(size_t segment) {
+        return first_segment_size << segment;
+    }
+
+    Slot* segment(size_t k) {
+        Slot* s = segments[k].load(std::memory_order_acquire);
+        if (s) {
+            return s;
+        }
+        Slot* fresh = new Slot[segment_size(k)];
+        if (segments[k].compare_exchange_strong(s, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        delete[] fresh;
+        return s;
+    }
+
+    Slot& slot(size_t index) {
+        size_t k = segment_of(index);
+        return segment(k)[index - segment_start(k)];
+    }
+
+    const Slot& published_slot(size_t index) const {
+        size_t k = segment_of(index);
+        return segments[k].load(std::memory_order_acquire)[index - segment_start(k)];
+    }
+
+    // Never moves reserved past capacity, so a failed reservation leaves
+    // the array as it was.
+    size_t reserve(size_t count) {
+        size_t begin = reserved.load();
+        do {
+            if (count > capacity - begin) {
+                throw std::length_error("ConcurrentFigureArray is full");
+            }
+        } while (!reserved.compare_exchange_weak(begin, begin + count));
+        return begin;
+    }
+
+    // Called only once the figure's slot is reserved.
+    void account(const Figure& figure) {
+        double value = figure.area();
+        size_t shard = std::hash<std::thread::id>()(std::this_thread::get_id()) % area_shards;
+        area[shard].sum.fetch_add(value, std::memory_order_relaxed);
+        type_counts[static_cast<size_t>(figure.type())].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void store(size_t index, std::shared_ptr<const Figure> figure) {
+        Slot& s = slot(index);
+        s.figure = std::move(figure);
+        s.ready.store(true);
+    }
+
+    // Moves published past every leading slot that is ready. Whichever
+    // writer completes the oldest pending slot carries the count forward
+    // over the slots finished before it. The ready flags and the counter
+    // use sequentially consistent operations so that two writers finishing
+    // neighbouring slots cannot both miss each other's flag.
+    void publish() {
+        size_t p = published.load();
+        while (p < reserved.load()) {
+            Slot* s = segments[segment_of(p)].load();
+            if (!s || !s[p - segment_start(segment_of(p))].ready.load()) {
+                break;
+            }
+            if (published.compare_exchange_weak(p, p + 1)) {
+                ++p;
+            }
+        }
+    }
+
+public:
+    ConcurrentFigureArray() = default;
+    ConcurrentFigureArray(const ConcurrentFigureArray& other) = delete;
+    ConcurrentFigureArray& operator=(const ConcurrentFigureArray& other) = delete;
+
+    ~ConcurrentFigureArray() {
+        for (auto& s : segments) {
+            delete[] s.load();
+        }
+    }
+
+    // Returns the figure's index. It becomes visible to readers once all
+    // earlier reservations are published too.
+    size_t add(std::shared_ptr<Figure> figure) {
+        if (!figure) {
+            throw std::invalid_argument("Figure cannot be null");
+        }
+        size_t index = reserve(1);
+        account(*figure);
+        store(index, std::move(figure));
+        publish();
+        return index;
+    }
+
+    // Appends the figures as one contiguous chunk, in order; returns the
+    // index of the first one.
+    size_t add(std::vector<std::shared_ptr<Figure>> figures) {
+        for (const auto& figure : figures) {
+            if (!figure) {
+                throw std::invalid_argument("Figure cannot be null");
+            }
+        }
+        size_t begin = reserve(figures.size());
+        for (size_t i = 0; i < figures.size(); ++i) {
+            account(*figures[i]);
+            store(begin + i, std::move(figures[i]));
+        }
+        publish();
+        return begin;
+    }
+
+    // Number of published figures; get(i) is valid for every i below it.
+    size_t size() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    // Read-only: published figures are shared with concurrent readers.
+    std::shared_ptr<const Figure> get(size_t index) const {
+        if (index < size()) {
+            return published_slot(index).figure;
+        }
+        return nullptr;
+    }
+
+    // Sum over all added figures, including ones that are not published yet.
+    double total_area() const {
+        double total = 0;
+        for (const auto& shard : area) {
+            total += shard.sum.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    size_t count(FigureType type) const {
+        return type_counts[static_cast<size_t>(type)].load(std::memory_order_relaxed);
+    }
+
+    // Copies the published figures into a FigureArray's pool, so the
+    // snapshot can be changed without touching the figures readers see.
+    FigureArray snapshot() const {
+        size_t n = size();
+        FigureArray array;
+        array.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            array.add_clone(*published_slot(i).figure);
+        }
+        return array;
+    }
+};
+
+#endif
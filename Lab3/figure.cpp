@@ -1,4 +1,31 @@
 #include "figure.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+const char* figure_type_name(FigureType type) {
+    switch (type) {
+        case FigureType::Rhombus:
+            return "Rhombus";
+        case FigureType::Pentagon:
+            return "Pentagon";
+        case FigureType::Hexagon:
+            return "Hexagon";
+        case FigureType::Other:
+            break;
+    }
+    return "Figure";
+}
+
+void Figure::print(std::ostream& os) const {
+    struct StreamOut {
+        std::ostream& os;
+        void text(std::string_view s) { os << s; }
+        void number(double value) { os << value; }
+    } out{os};
+    describe(out, *this);
+}
 
 std::ostream& operator<<(std::ostream& os, const Figure& figure) {
     figure.print(os);
@@ -8,4 +35,81 @@ std::ostream& operator<<(std::ostream& os, const Figure& figure) {
 std::istream& operator>>(std::istream& is, Figure& figure) {
     figure.read(is);
     return is;
-}
\ No newline at end of file
+}
+
+BoundingBox Figure::bounding_box() const {
+    BoundingBox box{vertex(0), vertex(0)};
+    for (size_t i = 1; i < vertex_count(); ++i) {
+        const Point& p = vertex(i);
+        box.min.x = std::min(box.min.x, p.x);
+        box.min.y = std::min(box.min.y, p.y);
+        box.max.x = std::max(box.max.x, p.x);
+        box.max.y = std::max(box.max.y, p.y);
+    }
+    return box;
+}
+
+namespace {
+
+uint64_t bucket_bits(double q) {
+    if (q == 0) q = 0;  // -0 and +0 must hash alike
+    uint64_t bits;
+    std::memcpy(&bits, &q, sizeof(bits));
+    return bits;
+}
+
+uint64_t coordinate_bits(double value) {
+    return bucket_bits(std::round(value / figure_hash_quantum));
+}
+
+uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h * 0xff51afd7ed558ccdULL;
+}
+
+}
+
+size_t Figure::hash() const {
+    uint64_t h = static_cast<uint64_t>(tag) + 1;
+    for (size_t i = 0; i < vertex_count(); ++i) {
+        const Point& p = vertex(i);
+        h = mix(h, coordinate_bits(p.x));
+        h = mix(h, coordinate_bits(p.y));
+    }
+    return static_cast<size_t>(h ^ (h >> 32));
+}
+
+// Rounding puts the boundaries at half quanta, away from the short
+// decimals coordinates usually have. A coordinate within the tolerance of
+// one gets its neighbouring bucket as an alternative.
+std::vector<size_t> Figure::equal_hashes() const {
+    const double margin = point_tolerance / figure_hash_quantum;
+    std::vector<uint64_t> own;
+    std::vector<std::pair<size_t, uint64_t>> alternatives;
+    for (size_t i = 0; i < vertex_count(); ++i) {
+        for (double value : {vertex(i).x, vertex(i).y}) {
+            double r = value / figure_hash_quantum;
+            double q = std::round(r);
+            if (0.5 - std::abs(r - q) <= margin) {
+                alternatives.emplace_back(own.size(), bucket_bits(r > q ? q + 1 : q - 1));
+            }
+            own.push_back(bucket_bits(q));
+        }
+    }
+
+    std::vector<size_t> result;
+    result.reserve(size_t(1) << alternatives.size());
+    std::vector<uint64_t> bits = own;
+    for (size_t mask = 0; mask < (size_t(1) << alternatives.size()); ++mask) {
+        for (size_t a = 0; a < alternatives.size(); ++a) {
+            size_t c = alternatives[a].first;
+            bits[c] = mask & (size_t(1) << a) ? alternatives[a].second : own[c];
+        }
+        uint64_t h = static_cast<uint64_t>(tag) + 1;
+        for (uint64_t b : bits) {
+            h = mix(h, b);
+        }
+        result.push_back(static_cast<size_t>(h ^ (h >> 32)));
+    }
+    return result;
+}
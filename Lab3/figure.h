@@ -5,32 +5,123 @@
 #include <vector>
 #include <cmath>
 #include <memory>
+#include <cstdint>
+#include <string_view>
+#include "pool_allocator.h"
 
 
+constexpr double point_tolerance = 1e-9;
+
 struct Point {
     double x, y;
     Point(double x = 0, double y = 0) : x(x), y(y) {}
     bool operator==(const Point& other) const {
-        return std::abs(x - other.x) < 1e-9 && std::abs(y - other.y) < 1e-9;
+        return std::abs(x - other.x) < point_tolerance && std::abs(y - other.y) < point_tolerance;
     }
 };
 
 
+struct BoundingBox {
+    Point min, max;
+};
+
+
+// Other covers figures defined outside this library; they go through the
+// virtual interface everywhere the built-in types have a fast path.
+enum class FigureType : uint8_t {
+    Rhombus,
+    Pentagon,
+    Hexagon,
+    Other
+};
+
+constexpr size_t figure_type_count = 4;
+
+const char* figure_type_name(FigureType type);
+
+// Much coarser than point_tolerance, so that equal coordinates can only
+// fall into the same or a neighbouring bucket.
+constexpr double figure_hash_quantum = 1e-6;
+
+
+struct Affine;
+
+
+// The concrete type is stored as a tag next to the vtable pointer, so
+// type checks (and equality between different types) need no virtual
+// call or dynamic_cast. The const interface never modifies the figure:
+// any number of threads may read one figure as long as none mutates it.
 class Figure {
+private:
+    FigureType tag;
+
+protected:
+    // For figures outside the built-in set.
+    Figure() : tag(FigureType::Other) {}
+    explicit Figure(FigureType type) : tag(type) {}
+
 public:
     virtual ~Figure() = default;
     
     virtual Point center() const = 0;
     virtual double area() const = 0;
-    virtual void print(std::ostream& os) const = 0;
+    // Writes the describe() layout with the stream's own formatting.
+    virtual void print(std::ostream& os) const;
     virtual void read(std::istream& is) = 0;
+
+    virtual size_t vertex_count() const = 0;
+    virtual const Point& vertex(size_t i) const = 0;
+
+    // Maps every vertex through t. The stored center is mapped along with
+    // them, and the stored area is rescaled when the shape's area formula
+    // allows it, so neither has to be recomputed from the vertices.
+    virtual void apply(const Affine& t) = 0;
+    // Whether apply(t) is allowed; apply throws std::invalid_argument when
+    // it is not.
+    virtual bool accepts(const Affine&) const { return true; }
+
+    FigureType type() const { return tag; }
+    BoundingBox bounding_box() const;
+
+    // Hash of the type and of the vertex coordinates rounded to multiples
+    // of figure_hash_quantum. Figures that are equal within
+    // point_tolerance usually hash alike, but not when a coordinate lies
+    // right next to a rounding boundary.
+    size_t hash() const;
+    // Every hash a figure equal to this one can have: hash() plus the
+    // combinations where coordinates within point_tolerance of a rounding
+    // boundary fall on its other side. Usually just {hash()}; at most
+    // 2^(2 * vertex_count()) entries.
+    std::vector<size_t> equal_hashes() const;
     
     virtual std::shared_ptr<Figure> clone() const = 0;
-    virtual bool operator==(const Figure& other) const = 0;
+    // Copy whose object and control block come from alloc's resource.
+    virtual std::shared_ptr<Figure> clone(const PoolAllocator<Figure>& alloc) const = 0;
+    virtual bool equals(const Figure& other) const = 0;
+    // Non-virtual so that C++20 rewritten comparisons between two different
+    // figure types find a single candidate.
+    bool operator==(const Figure& other) const { return equals(other); }
     
     friend std::ostream& operator<<(std::ostream& os, const Figure& figure);
     friend std::istream& operator>>(std::istream& is, Figure& figure);
     operator double() const { return area(); }
 };
 
+// The text operator<< writes for a figure: "<Type> vertices: (x, y) ...".
+// FigurePrinter fills in the same layout with its own number formatting;
+// out needs text(std::string_view) and number(double).
+template <typename Out>
+void describe(Out& out, const Figure& figure) {
+    out.text(figure_type_name(figure.type()));
+    out.text(" vertices: ");
+    for (size_t i = 0; i < figure.vertex_count(); ++i) {
+        const Point& p = figure.vertex(i);
+        out.text(i == 0 ? "(" : " (");
+        out.number(p.x);
+        out.text(", ");
+        out.number(p.y);
+        out.text(")");
+    }
+}
+
 #endif
\ No newline at end of file
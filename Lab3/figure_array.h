@@ -4,50 +4,775 @@
 #include <iostream>
 #include <vector>
 #include <memory>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <memory_resource>
+#include <compare>
+#include <iterator>
+#include <ranges>
 #include "figure.h"
+#include "affine.h"
+#include "parallel.h"
+#include "figure_handle.h"
+#include "spatial_grid.h"
+#include "figure_printer.h"
 
+// Keeps running aggregates (total area, count per type, bounding extents)
+// that add/remove update in O(1). Change stored figures through update();
+// call refresh() if they were changed through some other pointer.
 class FigureArray {
 private:
     std::vector<std::shared_ptr<Figure>> figures;
-    
+
+    // Slot map: slots[h.slot] locates a handle's figure in the dense
+    // vector, dense_slots maps back from a dense index to its slot.
+    struct Slot {
+        size_t index;
+        uint32_t generation;
+    };
+    std::vector<Slot> slots;
+    std::vector<uint32_t> dense_slots;
+    std::vector<uint32_t> free_slots;
+
+    std::optional<SpatialGrid> spatial_index;
+
+    // Figure::hash -> slot, for find_equal.
+    std::optional<std::unordered_multimap<size_t, uint32_t>> equality_index;
+
+    // Slab pool for emplace/add_clone, created on first use and shared by
+    // copies of the array. Every pooled figure also holds a reference to
+    // it, so the pool lives until the last of them is released.
+    std::shared_ptr<std::pmr::memory_resource> pool;
+
+    bool compensated;
+    double area_sum = 0;
+    double area_compensation = 0;
+    std::array<size_t, figure_type_count> type_counts{};
+    // Grown by every add. Removing or changing a figure that touched the
+    // box only clears extents_valid; bounds() rescans on demand, so a run
+    // of removals pays for one O(n) pass at most.
+    BoundingBox extents{};
+    bool extents_valid = true;
+
+    // Neumaier's variant of Kahan summation: the rounding error of every
+    // addition is collected separately so add/remove cycles do not drift.
+    void accumulate_area(double value) {
+        if (!compensated) {
+            area_sum += value;
+            return;
+        }
+        double t = area_sum + value;
+        if (std::abs(area_sum) >= std::abs(value)) {
+            area_compensation += (area_sum - t) + value;
+        } else {
+            area_compensation += (value - t) + area_sum;
+        }
+        area_sum = t;
+    }
+
+    void include_extents(const BoundingBox& box) {
+        if (figures.size() == 1) {
+            extents = box;
+            return;
+        }
+        extents.min.x = std::min(extents.min.x, box.min.x);
+        extents.min.y = std::min(extents.min.y, box.min.y);
+        extents.max.x = std::max(extents.max.x, box.max.x);
+        extents.max.y = std::max(extents.max.y, box.max.y);
+    }
+
+    void on_added(const Figure& figure) {
+        accumulate_area(figure.area());
+        ++type_counts[static_cast<size_t>(figure.type())];
+        if (extents_valid) {
+            include_extents(figure.bounding_box());
+        }
+    }
+
+    // Replaces a figure that is also held elsewhere (by a copy of the
+    // array, a caller, or another slot of this array) with a private copy,
+    // so changing it affects this slot only.
+    void detach(size_t index) {
+        if (figures[index].use_count() > 1) {
+            figures[index] = figures[index]->clone(allocator());
+        }
+    }
+
+    void settle_extents() {
+        if (extents_valid || figures.empty()) {
+            extents_valid = true;
+            return;
+        }
+        extents = figures[0]->bounding_box();
+        for (size_t i = 1; i < figures.size(); ++i) {
+            BoundingBox box = figures[i]->bounding_box();
+            extents.min.x = std::min(extents.min.x, box.min.x);
+            extents.min.y = std::min(extents.min.y, box.min.y);
+            extents.max.x = std::max(extents.max.x, box.max.x);
+            extents.max.y = std::max(extents.max.y, box.max.y);
+        }
+        extents_valid = true;
+    }
+
+    void on_removed(const Figure& figure) {
+        --type_counts[static_cast<size_t>(figure.type())];
+        if (figures.empty()) {
+            area_sum = 0;
+            area_compensation = 0;
+            extents_valid = true;
+            return;
+        }
+        accumulate_area(-figure.area());
+        if (extents_valid) {
+            BoundingBox box = figure.bounding_box();
+            extents_valid = box.min.x > extents.min.x && box.min.y > extents.min.y &&
+                            box.max.x < extents.max.x && box.max.y < extents.max.y;
+        }
+    }
+
+    // Indices of the k figures with the smallest key(figure), ordered by
+    // key and then index. Each block keeps only its own k best candidates
+    // (nth_element), so the final selection runs over at most
+    // k * block_count(n) entries.
+    template <typename Key>
+    std::vector<size_t> smallest_k(Key key, size_t k, size_t threads) const {
+        size_t n = figures.size();
+        k = std::min(k, n);
+        if (k == 0) {
+            return {};
+        }
+        std::vector<std::pair<double, size_t>> keyed(n);
+        std::vector<size_t> kept(block_count(n), 0);
+        parallel_blocks(n, threads, [&](size_t block, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                keyed[i] = {key(static_cast<const Figure&>(*figures[i])), i};
+            }
+            size_t m = std::min(k, end - begin);
+            if (m < end - begin) {
+                std::nth_element(keyed.begin() + begin, keyed.begin() + begin + m, keyed.begin() + end);
+            }
+            kept[block] = m;
+        });
+        size_t candidates = 0;
+        for (size_t b = 0; b < kept.size(); ++b) {
+            auto first = keyed.begin() + b * parallel_block_size;
+            candidates = std::move(first, first + kept[b], keyed.begin() + candidates) - keyed.begin();
+        }
+        keyed.resize(candidates);
+        std::nth_element(keyed.begin(), keyed.begin() + (k - 1), keyed.end());
+        keyed.resize(k);
+        std::sort(keyed.begin(), keyed.end());
+
+        std::vector<size_t> result(k);
+        for (size_t i = 0; i < k; ++i) {
+            result[i] = keyed[i].second;
+        }
+        return result;
+    }
+
+    FigureHandle acquire_slot(size_t index) {
+        uint32_t slot;
+        if (!free_slots.empty()) {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot{0, 0});
+        }
+        slots[slot].index = index;
+        dense_slots.push_back(slot);
+        return FigureHandle{slot, slots[slot].generation};
+    }
+
+    void unindex(uint32_t slot, const Figure& figure) {
+        if (spatial_index) {
+            spatial_index->erase(FigureHandle{slot, slots[slot].generation});
+        }
+        if (equality_index) {
+            auto range = equality_index->equal_range(figure.hash());
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == slot) {
+                    equality_index->erase(it);
+                    break;
+                }
+            }
+        }
+    }
+
+    void release_slot(uint32_t slot, const Figure& figure) {
+        unindex(slot, figure);
+        ++slots[slot].generation;
+        free_slots.push_back(slot);
+    }
+
 public:
-    void add(std::shared_ptr<Figure> figure) {
+    // Random-access iterator yielding const Figure&, so a FigureArray is a
+    // std::ranges::random_access_range and works with the standard views.
+    class const_iterator {
+    private:
+        std::vector<std::shared_ptr<Figure>>::const_iterator it;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Figure;
+        using difference_type = std::ptrdiff_t;
+        using reference = const Figure&;
+        using pointer = const Figure*;
+
+        const_iterator() = default;
+        explicit const_iterator(std::vector<std::shared_ptr<Figure>>::const_iterator it) : it(it) {}
+
+        reference operator*() const { return **it; }
+        pointer operator->() const { return it->get(); }
+        reference operator[](difference_type n) const { return *it[n]; }
+
+        const_iterator& operator++() { ++it; return *this; }
+        const_iterator operator++(int) { return const_iterator(it++); }
+        const_iterator& operator--() { --it; return *this; }
+        const_iterator operator--(int) { return const_iterator(it--); }
+        const_iterator& operator+=(difference_type n) { it += n; return *this; }
+        const_iterator& operator-=(difference_type n) { it -= n; return *this; }
+
+        friend const_iterator operator+(const_iterator i, difference_type n) { return i += n; }
+        friend const_iterator operator+(difference_type n, const_iterator i) { return i += n; }
+        friend const_iterator operator-(const_iterator i, difference_type n) { return i -= n; }
+        friend difference_type operator-(const const_iterator& a, const const_iterator& b) { return a.it - b.it; }
+
+        bool operator==(const const_iterator& other) const = default;
+        auto operator<=>(const const_iterator& other) const = default;
+    };
+    using iterator = const_iterator;
+
+    explicit FigureArray(bool compensated_sum = false) : compensated(compensated_sum) {}
+
+    FigureHandle add(std::shared_ptr<Figure> figure) {
+        if (!figure) {
+            throw std::invalid_argument("Figure cannot be null");
+        }
+        FigureHandle handle = acquire_slot(figures.size());
         figures.push_back(figure);
+        on_added(*figure);
+        if (spatial_index) {
+            spatial_index->insert(handle, figure->bounding_box(), figure->center());
+        }
+        if (equality_index) {
+            equality_index->emplace(figure->hash(), handle.slot);
+        }
+        return handle;
+    }
+
+    // Constructs a T in the array's pool with std::allocate_shared: the
+    // figure and its control block share one allocation, and figures of
+    // one array sit together in the pool's slabs.
+    template <typename T, typename... Args>
+    FigureHandle emplace(Args&&... args) {
+        static_assert(std::is_base_of_v<Figure, T>, "T must be a Figure");
+        return add(std::allocate_shared<T>(PoolAllocator<T>(allocator()), std::forward<Args>(args)...));
+    }
+
+    // Adds a copy of figure allocated from the array's pool.
+    FigureHandle add_clone(const Figure& figure) {
+        return add(figure.clone(allocator()));
     }
-    
+
+    PoolAllocator<Figure> allocator() {
+        if (!pool) {
+            // Synchronized: figures may be released on any thread.
+            pool = std::make_shared<std::pmr::synchronized_pool_resource>();
+        }
+        return PoolAllocator<Figure>(pool);
+    }
+
+    // Keeps the order of the remaining figures; O(n).
     void remove(size_t index) {
         if (index < figures.size()) {
+            std::shared_ptr<Figure> removed = figures[index];
+            release_slot(dense_slots[index], *removed);
             figures.erase(figures.begin() + index);
+            dense_slots.erase(dense_slots.begin() + index);
+            for (size_t i = index; i < dense_slots.size(); ++i) {
+                slots[dense_slots[i]].index = i;
+            }
+            on_removed(*removed);
         }
     }
-    
+
+    // Moves the last figure into the freed position; O(1). Returns false
+    // for a stale handle.
+    bool remove(FigureHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        size_t index = slots[handle.slot].index;
+        std::shared_ptr<Figure> removed = std::move(figures[index]);
+        size_t last = figures.size() - 1;
+        if (index != last) {
+            figures[index] = std::move(figures[last]);
+            dense_slots[index] = dense_slots[last];
+            slots[dense_slots[index]].index = index;
+        }
+        figures.pop_back();
+        dense_slots.pop_back();
+        release_slot(handle.slot, *removed);
+        on_removed(*removed);
+        return true;
+    }
+
+    // The only way to change a stored figure in place: f gets a mutable
+    // reference, and the totals, type counts, bounds and indexes are
+    // updated around it. A figure also held elsewhere is copied first, so
+    // other holders keep the original. If f throws, everything is rebuilt
+    // from the figures as they are. Returns false for a stale handle.
+    template <typename F>
+    bool update(FigureHandle handle, F f) {
+        if (!contains(handle)) {
+            return false;
+        }
+        size_t index = slots[handle.slot].index;
+        detach(index);
+        Figure& figure = *figures[index];
+        unindex(handle.slot, figure);
+        accumulate_area(-figure.area());
+        --type_counts[static_cast<size_t>(figure.type())];
+        BoundingBox old_box = figure.bounding_box();
+        bool interior = extents_valid &&
+                        old_box.min.x > extents.min.x && old_box.min.y > extents.min.y &&
+                        old_box.max.x < extents.max.x && old_box.max.y < extents.max.y;
+
+        try {
+            f(figure);
+        } catch (...) {
+            refresh();
+            throw;
+        }
+
+        accumulate_area(figure.area());
+        ++type_counts[static_cast<size_t>(figure.type())];
+        if (interior) {
+            include_extents(figure.bounding_box());
+        } else {
+            extents_valid = false;
+        }
+        if (spatial_index) {
+            spatial_index->insert(handle, figure.bounding_box(), figure.center());
+        }
+        if (equality_index) {
+            equality_index->emplace(figure.hash(), handle.slot);
+        }
+        return true;
+    }
+
+    bool contains(FigureHandle handle) const {
+        return handle.slot < slots.size() && slots[handle.slot].generation == handle.generation;
+    }
+
+    std::optional<size_t> index_of(FigureHandle handle) const {
+        if (!contains(handle)) {
+            return std::nullopt;
+        }
+        return slots[handle.slot].index;
+    }
+
+    FigureHandle handle_at(size_t index) const {
+        if (index < dense_slots.size()) {
+            uint32_t slot = dense_slots[index];
+            return FigureHandle{slot, slots[slot].generation};
+        }
+        return FigureHandle{};
+    }
+
     double total_area() const {
-        double total = 0;
+        return area_sum + area_compensation;
+    }
+
+    size_t count(FigureType type) const {
+        return type_counts[static_cast<size_t>(type)];
+    }
+
+    // O(1) unless a figure on the outer box was removed or changed since
+    // the last call; then the box is rescanned once in O(n). Not const for
+    // that reason: the rescan writes, so concurrent callers need a lock.
+    std::optional<BoundingBox> bounds() {
+        if (figures.empty()) {
+            return std::nullopt;
+        }
+        settle_extents();
+        return extents;
+    }
+
+    // Builds a uniform grid over the current figures and keeps it in sync
+    // with add/remove from then on.
+    void enable_spatial_index(double cell_size) {
+        spatial_index.emplace(cell_size);
+        for (size_t i = 0; i < figures.size(); ++i) {
+            spatial_index->insert(handle_at(i), figures[i]->bounding_box(), figures[i]->center());
+        }
+    }
+
+    void disable_spatial_index() {
+        spatial_index.reset();
+    }
+
+    bool has_spatial_index() const {
+        return spatial_index.has_value();
+    }
+
+    // Hash index over Figure::hash, kept in sync with add/remove, that lets
+    // find_equal run in expected O(1). See Figure::hash for how figures
+    // equal only within tolerance are treated.
+    void enable_equality_index() {
+        equality_index.emplace();
+        equality_index->reserve(figures.size());
+        for (size_t i = 0; i < figures.size(); ++i) {
+            equality_index->emplace(figures[i]->hash(), dense_slots[i]);
+        }
+    }
+
+    void disable_equality_index() {
+        equality_index.reset();
+    }
+
+    bool has_equality_index() const {
+        return equality_index.has_value();
+    }
+
+    // A figure that compares equal to the given one. Falls back to a
+    // linear scan when no equality index is enabled.
+    std::optional<FigureHandle> find_equal(const Figure& figure) const {
+        if (equality_index) {
+            for (size_t h : figure.equal_hashes()) {
+                auto range = equality_index->equal_range(h);
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (*figures[slots[it->second].index] == figure) {
+                        return FigureHandle{it->second, slots[it->second].generation};
+                    }
+                }
+            }
+            return std::nullopt;
+        }
+        for (size_t i = 0; i < figures.size(); ++i) {
+            if (*figures[i] == figure) {
+                return handle_at(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Removes every figure equal to an earlier one, keeping the order of
+    // the rest. Returns the number removed. One pass, expected O(n).
+    size_t deduplicate() {
+        std::unordered_multimap<size_t, size_t> seen;
+        seen.reserve(figures.size());
+        std::vector<std::shared_ptr<Figure>> removed;
+        size_t kept = 0;
+        for (size_t i = 0; i < figures.size(); ++i) {
+            const Figure& figure = *figures[i];
+            bool duplicate = false;
+            for (size_t h : figure.equal_hashes()) {
+                auto range = seen.equal_range(h);
+                for (auto it = range.first; it != range.second && !duplicate; ++it) {
+                    duplicate = *figures[it->second] == figure;
+                }
+            }
+            if (duplicate) {
+                release_slot(dense_slots[i], figure);
+                removed.push_back(std::move(figures[i]));
+                continue;
+            }
+            if (kept != i) {
+                figures[kept] = std::move(figures[i]);
+                dense_slots[kept] = dense_slots[i];
+                slots[dense_slots[kept]].index = kept;
+            }
+            seen.emplace(figure.hash(), kept);
+            ++kept;
+        }
+        figures.resize(kept);
+        dense_slots.resize(kept);
+        for (const auto& figure : removed) {
+            on_removed(*figure);
+        }
+        return removed.size();
+    }
+
+    // Figures whose bounding box intersects the region. Falls back to a
+    // linear scan when no spatial index is enabled.
+    std::vector<FigureHandle> query_region(const BoundingBox& region) const {
+        if (spatial_index) {
+            return spatial_index->query(region);
+        }
+        std::vector<FigureHandle> result;
+        for (size_t i = 0; i < figures.size(); ++i) {
+            BoundingBox box = figures[i]->bounding_box();
+            if (box.min.x <= region.max.x && region.min.x <= box.max.x &&
+                box.min.y <= region.max.y && region.min.y <= box.max.y) {
+                result.push_back(handle_at(i));
+            }
+        }
+        return result;
+    }
+
+    // Up to k figures ordered by the distance from their center to p,
+    // closest first. Uses the spatial index when enabled; otherwise every
+    // figure is scanned on the given number of threads.
+    std::vector<FigureHandle> nearest(const Point& p, size_t k, size_t threads = 0) const {
+        if (spatial_index) {
+            return spatial_index->nearest(p, k);
+        }
+        std::vector<size_t> indices = smallest_k([&p](const Figure& f) {
+            Point c = f.center();
+            return (c.x - p.x) * (c.x - p.x) + (c.y - p.y) * (c.y - p.y);
+        }, k, threads);
+        std::vector<FigureHandle> result(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i) {
+            result[i] = handle_at(indices[i]);
+        }
+        return result;
+    }
+
+    // Indices of the k largest figures by area, largest first; equal areas
+    // keep index order. Nothing is copied but the keys.
+    std::vector<size_t> top_k_by_area(size_t k, size_t threads = 0) const {
+        return smallest_k([](const Figure& f) { return -f.area(); }, k, threads);
+    }
+
+    void refresh() {
+        area_sum = 0;
+        area_compensation = 0;
+        type_counts.fill(0);
         for (const auto& figure : figures) {
-            total += figure->area();
+            accumulate_area(figure->area());
+            ++type_counts[static_cast<size_t>(figure->type())];
+        }
+        extents_valid = false;
+        if (spatial_index) {
+            enable_spatial_index(spatial_index->cell_size());
+        }
+        if (equality_index) {
+            enable_equality_index();
+        }
+    }
+
+    // Applies t to every figure. Shared figures are copied first (see
+    // detach), so each stored figure is transformed exactly once and other
+    // holders keep the original. For similarities the running area total
+    // is rescaled instead of recomputed; axis-aligned maps carry the bounds
+    // along. Spatial and equality indexes are rebuilt.
+    void transform(const Affine& t, size_t threads = 0) {
+        for (const auto& figure : figures) {
+            if (!figure->accepts(t)) {
+                throw std::invalid_argument("Transform does not apply to every figure");
+            }
+        }
+        for (size_t i = 0; i < figures.size(); ++i) {
+            detach(i);
+        }
+        parallel_blocks(figures.size(), threads, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                figures[i]->apply(t);
+            }
+        });
+        if (t.is_similarity()) {
+            double scale = std::abs(t.determinant());
+            area_sum *= scale;
+            area_compensation *= scale;
+        } else {
+            area_sum = 0;
+            area_compensation = 0;
+            for (const auto& figure : figures) {
+                accumulate_area(figure->area());
+            }
+        }
+        if (extents_valid && t.is_axis_aligned()) {
+            Point p = t.apply(extents.min);
+            Point q = t.apply(extents.max);
+            extents.min = Point(std::min(p.x, q.x), std::min(p.y, q.y));
+            extents.max = Point(std::max(p.x, q.x), std::max(p.y, q.y));
+        } else {
+            extents_valid = false;
+        }
+        if (spatial_index) {
+            enable_spatial_index(spatial_index->cell_size());
+        }
+        if (equality_index) {
+            enable_equality_index();
+        }
+    }
+
+    // Recomputes the total from the figures. Per-block sums are added in
+    // block order, so the result does not depend on the thread count.
+    double parallel_total_area(size_t threads = 0) const {
+        std::vector<double> partial(block_count(figures.size()), 0.0);
+        parallel_blocks(figures.size(), threads, [&](size_t block, size_t begin, size_t end) {
+            double sum = 0;
+            for (size_t i = begin; i < end; ++i) {
+                sum += figures[i]->area();
+            }
+            partial[block] = sum;
+        });
+        double total = 0;
+        for (double sum : partial) {
+            total += sum;
         }
         return total;
     }
-    
-    void print_all() const {
+
+    // f may modify the figures it is given; shared figures are copied
+    // first (see detach), and the aggregates and indexes are rebuilt
+    // afterwards, also when f throws. Use parallel_transform or
+    // parallel_count_if for read-only passes.
+    template <typename F>
+    void parallel_for_each(F f, size_t threads = 0) {
         for (size_t i = 0; i < figures.size(); ++i) {
-            std::cout << "Figure " << i << ": " << *figures[i] 
-                      << ", Area: " << figures[i]->area() 
-                      << ", Center: (" << figures[i]->center().x 
-                      << ", " << figures[i]->center().y << ")" << std::endl;
+            detach(i);
+        }
+        try {
+            parallel_blocks(figures.size(), threads, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    f(*figures[i]);
+                }
+            });
+        } catch (...) {
+            refresh();
+            throw;
+        }
+        refresh();
+    }
+
+    template <typename F>
+    auto parallel_transform(F f, size_t threads = 0) const {
+        using Result = std::decay_t<decltype(f(std::declval<const Figure&>()))>;
+        static_assert(!std::is_same_v<Result, bool>,
+                      "std::vector<bool> cannot be written from several threads");
+        std::vector<Result> result(figures.size());
+        parallel_blocks(figures.size(), threads, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                result[i] = f(static_cast<const Figure&>(*figures[i]));
+            }
+        });
+        return result;
+    }
+
+    template <typename Pred>
+    size_t parallel_count_if(Pred pred, size_t threads = 0) const {
+        std::vector<size_t> partial(block_count(figures.size()), 0);
+        parallel_blocks(figures.size(), threads, [&](size_t block, size_t begin, size_t end) {
+            size_t n = 0;
+            for (size_t i = begin; i < end; ++i) {
+                if (pred(static_cast<const Figure&>(*figures[i]))) ++n;
+            }
+            partial[block] = n;
+        });
+        size_t total = 0;
+        for (size_t n : partial) {
+            total += n;
+        }
+        return total;
+    }
+
+    // Numbers follow the stream's float field, precision and locale.
+    void print_all(std::ostream& os = std::cout) const {
+        OstreamSink sink(os);
+        print_all(sink, 0, NumberFormat(os));
+    }
+
+    // Blocks of figures are formatted concurrently, a few blocks per thread
+    // at a time, and written to the sink in order. Sink errors propagate.
+    void print_all(OutputSink& sink, size_t threads = 0,
+                   const NumberFormat& number_format = NumberFormat()) const {
+        if (resolve_thread_count(threads) == 1) {
+            FigurePrinter printer(sink, number_format);
+            for (size_t i = 0; i < figures.size(); ++i) {
+                printer.print(i, *figures[i]);
+            }
+            printer.flush();
+            return;
         }
+        size_t per_round = 4 * resolve_thread_count(threads);
+        std::vector<std::string> chunks(per_round);
+        for (size_t first = 0; first < figures.size(); first += per_round * parallel_block_size) {
+            size_t n = std::min(figures.size() - first, per_round * parallel_block_size);
+            parallel_blocks(n, threads, [&](size_t block, size_t begin, size_t end) {
+                std::string& chunk = chunks[block];
+                chunk.clear();
+                for (size_t i = first + begin; i < first + end; ++i) {
+                    FigurePrinter::format(chunk, i, *figures[i], number_format);
+                }
+            });
+            for (size_t b = 0; b < block_count(n); ++b) {
+                sink.write(chunks[b].data(), chunks[b].size());
+            }
+        }
+        sink.flush();
     }
-    
+
     size_t size() const {
         return figures.size();
     }
-    
-    std::shared_ptr<Figure> get(size_t index) const {
+
+    const_iterator begin() const {
+        return const_iterator(figures.begin());
+    }
+
+    const_iterator end() const {
+        return const_iterator(figures.end());
+    }
+
+    // Lazy views over the figures; nothing is evaluated until iterated.
+    // The array must outlive the view and not change while it is in use.
+    template <typename Pred>
+    auto filter(Pred pred) const {
+        return std::views::filter(*this, std::move(pred));
+    }
+
+    template <typename F>
+    auto map(F f) const {
+        return std::views::transform(*this, std::move(f));
+    }
+
+    // Compares the stored type tag, so skipping a figure costs no virtual call.
+    auto of_type(FigureType type) const {
+        return filter([type](const Figure& figure) { return figure.type() == type; });
+    }
+
+    void reserve(size_t capacity) {
+        figures.reserve(capacity);
+        slots.reserve(capacity);
+        dense_slots.reserve(capacity);
+    }
+
+    // Read-only: change a stored figure through update() so the totals
+    // and indexes stay in sync.
+    std::shared_ptr<const Figure> get(size_t index) const {
         if (index < figures.size()) {
             return figures[index];
         }
         return nullptr;
     }
+
+    // Reference access without touching the shared_ptr reference count.
+    const Figure& at(size_t index) const {
+        if (index >= figures.size()) {
+            throw std::out_of_range("Figure index out of range");
+        }
+        return *figures[index];
+    }
+
+    std::shared_ptr<const Figure> get(FigureHandle handle) const {
+        if (contains(handle)) {
+            return figures[slots[handle.slot].index];
+        }
+        return nullptr;
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,152 @@
+#include "figure_columns.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Four independent accumulators break the dependency chain of a single
+// running sum so consecutive terms can be computed in packed registers.
+template <typename Term>
+double sum_terms(size_t n, Term term) {
+    double acc[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc[0] += term(i);
+        acc[1] += term(i + 1);
+        acc[2] += term(i + 2);
+        acc[3] += term(i + 3);
+    }
+    for (; i < n; ++i) {
+        acc[0] += term(i);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// Shoelace formula, as in Polygon::area. The vertex loop has a constant
+// trip count and is unrolled, leaving a straight-line kernel per figure.
+template <size_t N>
+double polygon_area(const VertexColumns<N>& c) {
+    std::array<const double*, N> x;
+    std::array<const double*, N> y;
+    for (size_t v = 0; v < N; ++v) {
+        x[v] = c.x[v].data();
+        y[v] = c.y[v].data();
+    }
+    return 0.5 * sum_terms(c.size(), [&](size_t i) {
+        double twice_area = 0;
+        for (size_t v = 0; v < N; ++v) {
+            size_t w = (v + 1) % N;
+            twice_area += x[v][i] * y[w][i] - x[w][i] * y[v][i];
+        }
+        return std::abs(twice_area);
+    });
+}
+
+template <size_t N>
+CenterColumns centers(const VertexColumns<N>& c) {
+    size_t n = c.size();
+    CenterColumns result;
+    result.x.assign(n, 0.0);
+    result.y.assign(n, 0.0);
+    double* cx = result.x.data();
+    double* cy = result.y.data();
+    for (size_t v = 0; v < N; ++v) {
+        const double* x = c.x[v].data();
+        const double* y = c.y[v].data();
+        for (size_t i = 0; i < n; ++i) {
+            cx[i] += x[i];
+            cy[i] += y[i];
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        cx[i] /= N;
+        cy[i] /= N;
+    }
+    return result;
+}
+
+}
+
+void FigureColumns::add(const Rhombus& rhombus) {
+    rhombi.push(rhombus);
+}
+
+void FigureColumns::add(const Pentagon& pentagon) {
+    pentagons.push(pentagon);
+}
+
+void FigureColumns::add(const Hexagon& hexagon) {
+    hexagons.push(hexagon);
+}
+
+void FigureColumns::add(const Figure& figure) {
+    switch (figure.type()) {
+        case FigureType::Rhombus:
+            add(static_cast<const Rhombus&>(figure));
+            break;
+        case FigureType::Pentagon:
+            add(static_cast<const Pentagon&>(figure));
+            break;
+        case FigureType::Hexagon:
+            add(static_cast<const Hexagon&>(figure));
+            break;
+        case FigureType::Other:
+            throw std::invalid_argument("FigureColumns stores only the built-in figure types");
+    }
+}
+
+size_t FigureColumns::rhombus_count() const {
+    return rhombi.size();
+}
+
+size_t FigureColumns::pentagon_count() const {
+    return pentagons.size();
+}
+
+size_t FigureColumns::hexagon_count() const {
+    return hexagons.size();
+}
+
+size_t FigureColumns::size() const {
+    return rhombi.size() + pentagons.size() + hexagons.size();
+}
+
+double FigureColumns::rhombus_area() const {
+    const double* x0 = rhombi.x[0].data();
+    const double* x1 = rhombi.x[1].data();
+    const double* x2 = rhombi.x[2].data();
+    const double* x3 = rhombi.x[3].data();
+    const double* y0 = rhombi.y[0].data();
+    const double* y1 = rhombi.y[1].data();
+    const double* y2 = rhombi.y[2].data();
+    const double* y3 = rhombi.y[3].data();
+    return 0.5 * sum_terms(rhombi.size(), [=](size_t i) {
+        double ax = x2[i] - x0[i], ay = y2[i] - y0[i];
+        double bx = x3[i] - x1[i], by = y3[i] - y1[i];
+        return std::abs(ax * by - ay * bx);
+    });
+}
+
+double FigureColumns::pentagon_area() const {
+    return polygon_area(pentagons);
+}
+
+double FigureColumns::hexagon_area() const {
+    return polygon_area(hexagons);
+}
+
+double FigureColumns::total_area() const {
+    return rhombus_area() + pentagon_area() + hexagon_area();
+}
+
+CenterColumns FigureColumns::rhombus_centers() const {
+    return centers(rhombi);
+}
+
+CenterColumns FigureColumns::pentagon_centers() const {
+    return centers(pentagons);
+}
+
+CenterColumns FigureColumns::hexagon_centers() const {
+    return centers(hexagons);
+}
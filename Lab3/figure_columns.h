@@ -0,0 +1,72 @@
+#ifndef FIGURE_COLUMNS_H
+#define FIGURE_COLUMNS_H
+
+#include <array>
+#include <vector>
+#include "figure.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include "hexagon.h"
+
+// Vertex coordinates of N-gons, one x and one y column per vertex slot:
+// x[v][i] is the x coordinate of vertex v of figure i.
+template <size_t N>
+struct VertexColumns {
+    std::array<std::vector<double>, N> x;
+    std::array<std::vector<double>, N> y;
+
+    size_t size() const {
+        return x[0].size();
+    }
+
+    void push(const Figure& figure) {
+        for (size_t v = 0; v < N; ++v) {
+            x[v].push_back(figure.vertex(v).x);
+            y[v].push_back(figure.vertex(v).y);
+        }
+    }
+
+    void reserve(size_t capacity) {
+        for (size_t v = 0; v < N; ++v) {
+            x[v].reserve(capacity);
+            y[v].reserve(capacity);
+        }
+    }
+};
+
+struct CenterColumns {
+    std::vector<double> x;
+    std::vector<double> y;
+};
+
+// Columnar copy of a set of figures, grouped by type. Areas and centers
+// are computed by kernels that walk whole columns, which the compiler
+// turns into packed SIMD arithmetic.
+class FigureColumns {
+private:
+    VertexColumns<4> rhombi;
+    VertexColumns<5> pentagons;
+    VertexColumns<6> hexagons;
+
+public:
+    void add(const Rhombus& rhombus);
+    void add(const Pentagon& pentagon);
+    void add(const Hexagon& hexagon);
+    void add(const Figure& figure);
+
+    size_t rhombus_count() const;
+    size_t pentagon_count() const;
+    size_t hexagon_count() const;
+    size_t size() const;
+
+    double rhombus_area() const;
+    double pentagon_area() const;
+    double hexagon_area() const;
+    double total_area() const;
+
+    CenterColumns rhombus_centers() const;
+    CenterColumns pentagon_centers() const;
+    CenterColumns hexagon_centers() const;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef FIGURE_HANDLE_H
+#define FIGURE_HANDLE_H
+
+#include <cstdint>
+#include <limits>
+
+// Stable reference to a figure in a FigureArray. It survives removals of
+// other figures and becomes stale (never dangling) once its figure is removed.
+struct FigureHandle {
+    uint32_t slot = std::numeric_limits<uint32_t>::max();
+    uint32_t generation = 0;
+
+    bool operator==(const FigureHandle& other) const {
+        return slot == other.slot && generation == other.generation;
+    }
+    bool operator!=(const FigureHandle& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif
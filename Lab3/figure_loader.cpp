@@ -0,0 +1,141 @@
+#include "figure_loader.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "hexagon.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "pentagon.h"
+#include "rhombus.h"
+
+namespace {
+
+struct ChunkResult {
+    std::vector<std::shared_ptr<Figure>> figures;
+    size_t lines = 0;
+    std::optional<std::pair<size_t, std::string>> error;
+};
+
+bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+std::string_view next_token(const char*& p, const char* end) {
+    while (p != end && is_blank(*p)) ++p;
+    const char* start = p;
+    while (p != end && !is_blank(*p)) ++p;
+    return std::string_view(start, p - start);
+}
+
+template <typename T, size_t N>
+std::shared_ptr<Figure> parse_vertices(const char*& p, const char* end, std::vector<Point>& scratch) {
+    std::array<double, 2 * N> coords;
+    for (size_t i = 0; i < coords.size(); ++i) {
+        std::string_view token = next_token(p, end);
+        if (token.empty()) {
+            throw std::invalid_argument("expected " + std::to_string(2 * N) + " coordinates");
+        }
+        auto [last, ec] = std::from_chars(token.data(), token.data() + token.size(), coords[i]);
+        if (ec != std::errc() || last != token.data() + token.size()) {
+            throw std::invalid_argument("invalid number '" + std::string(token) + "'");
+        }
+    }
+    scratch.resize(N);
+    for (size_t v = 0; v < N; ++v) {
+        scratch[v] = Point(coords[2 * v], coords[2 * v + 1]);
+    }
+    return std::make_shared<T>(scratch);
+}
+
+std::shared_ptr<Figure> parse_line(const char* p, const char* end, std::vector<Point>& scratch) {
+    std::string_view type = next_token(p, end);
+    std::shared_ptr<Figure> figure;
+    if (type == "rhombus") {
+        figure = parse_vertices<Rhombus, 4>(p, end, scratch);
+    } else if (type == "pentagon") {
+        figure = parse_vertices<Pentagon, 5>(p, end, scratch);
+    } else if (type == "hexagon") {
+        figure = parse_vertices<Hexagon, 6>(p, end, scratch);
+    } else {
+        throw std::invalid_argument("unknown figure type '" + std::string(type) + "'");
+    }
+    if (!next_token(p, end).empty()) {
+        throw std::invalid_argument("unexpected trailing data");
+    }
+    return figure;
+}
+
+void parse_chunk(std::string_view chunk, ChunkResult& result) {
+    std::vector<Point> scratch;
+    const char* p = chunk.data();
+    const char* end = p + chunk.size();
+    while (p != end) {
+        const char* eol = std::find(p, end, '\n');
+        ++result.lines;
+        const char* q = p;
+        while (q != eol && is_blank(*q)) ++q;
+        if (q != eol && *q != '#') {
+            try {
+                result.figures.push_back(parse_line(q, eol, scratch));
+            } catch (const std::exception& e) {
+                result.error.emplace(result.lines, e.what());
+                return;
+            }
+        }
+        p = eol == end ? end : eol + 1;
+    }
+}
+
+std::vector<std::string_view> split_lines(std::string_view text, size_t parts) {
+    std::vector<std::string_view> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= parts && begin < text.size(); ++i) {
+        size_t end = i == parts ? text.size() : std::max(begin, text.size() * i / parts);
+        end = std::min(text.size(), text.find('\n', end));
+        end = end == std::string_view::npos || end == text.size() ? text.size() : end + 1;
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+}
+
+FigureArray parse_figures(std::string_view text, size_t threads) {
+    threads = resolve_thread_count(threads);
+    std::vector<std::string_view> chunks = split_lines(text, threads);
+    std::vector<ChunkResult> results(chunks.size());
+
+    parallel_blocks(chunks.size(), threads, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            parse_chunk(chunks[i], results[i]);
+        }
+    }, 1);
+
+    size_t lines_before = 0;
+    size_t total = 0;
+    for (const auto& r : results) {
+        if (r.error) {
+            throw FigureParseError(lines_before + r.error->first, r.error->second);
+        }
+        lines_before += r.lines;
+        total += r.figures.size();
+    }
+
+    FigureArray array;
+    array.reserve(total);
+    for (auto& r : results) {
+        for (auto& figure : r.figures) {
+            array.add(std::move(figure));
+        }
+    }
+    return array;
+}
+
+FigureArray load_figures(const std::string& path, size_t threads) {
+    MappedFile file(path);
+    return parse_figures(file.view(), threads);
+}
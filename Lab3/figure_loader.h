@@ -0,0 +1,33 @@
+#ifndef FIGURE_LOADER_H
+#define FIGURE_LOADER_H
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "figure_array.h"
+
+class FigureParseError : public std::runtime_error {
+private:
+    size_t line_number;
+
+public:
+    FigureParseError(size_t line, const std::string& message)
+        : std::runtime_error("line " + std::to_string(line) + ": " + message), line_number(line) {}
+
+    size_t line() const {
+        return line_number;
+    }
+};
+
+// Text format, one figure per line:
+//     rhombus x0 y0 x1 y1 x2 y2 x3 y3
+//     pentagon x0 y0 ... x4 y4
+//     hexagon x0 y0 ... x5 y5
+// Blank lines and lines starting with '#' are skipped. Coordinates are
+// parsed with std::from_chars, independent of the current locale. The text
+// is split on line boundaries and the parts are parsed concurrently;
+// figures keep their order in the file.
+FigureArray parse_figures(std::string_view text, size_t threads = 0);
+FigureArray load_figures(const std::string& path, size_t threads = 0);
+
+#endif
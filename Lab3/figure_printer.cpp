@@ -0,0 +1,152 @@
+#include "figure_printer.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Output for describe(): appends to a string using a NumberFormat.
+struct StringOut {
+    std::string& out;
+    const NumberFormat& format;
+
+    void text(std::string_view s) { out.append(s); }
+    void number(double value) { format.append(out, value); }
+};
+
+}
+
+NumberFormat::NumberFormat(const std::ios_base& stream)
+    : flags(stream.flags()), precision(stream.precision()), locale(stream.getloc()) {
+    const auto changes_numbers = std::ios_base::showpos | std::ios_base::showpoint |
+                                 std::ios_base::showbase | std::ios_base::uppercase;
+    auto base = flags & std::ios_base::basefield;
+    auto field = flags & std::ios_base::floatfield;
+    direct = (flags & changes_numbers) == 0 &&
+             (base == std::ios_base::dec || base == std::ios_base::fmtflags()) &&
+             field != (std::ios_base::fixed | std::ios_base::scientific) &&
+             precision >= 0 && precision <= 64 &&
+             std::use_facet<std::numpunct<char>>(locale).grouping().empty() &&
+             std::use_facet<std::numpunct<char>>(locale).decimal_point() == '.';
+    if (field == std::ios_base::fixed) {
+        style = std::chars_format::fixed;
+    } else if (field == std::ios_base::scientific) {
+        style = std::chars_format::scientific;
+    }
+}
+
+void NumberFormat::append(std::string& out, double value) const {
+    if (!direct) {
+        std::ostringstream s;
+        apply(s);
+        s << value;
+        out += s.str();
+        return;
+    }
+    // Fixed notation of 1e308 with 64 decimals needs a little over 370.
+    char digits[400];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, style, static_cast<int>(precision));
+    out.append(digits, result.ptr);
+}
+
+void NumberFormat::append(std::string& out, size_t value) const {
+    if (!direct) {
+        std::ostringstream s;
+        apply(s);
+        s << value;
+        out += s.str();
+        return;
+    }
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void NumberFormat::apply(std::ios_base& stream) const {
+    stream.imbue(locale);
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void OstreamSink::write(const char* data, size_t size) {
+    if (!os.write(data, static_cast<std::streamsize>(size))) {
+        throw std::runtime_error("Failed to write figures to stream");
+    }
+}
+
+void OstreamSink::flush() {
+    if (!os.flush()) {
+        throw std::runtime_error("Failed to flush stream");
+    }
+}
+
+void FileSink::write(const char* data, size_t size) {
+    if (std::fwrite(data, 1, size, file) != size) {
+        throw std::runtime_error("Failed to write figures to file");
+    }
+}
+
+void FileSink::flush() {
+    if (std::fflush(file) != 0) {
+        throw std::runtime_error("Failed to flush file");
+    }
+}
+
+FigurePrinter::FigurePrinter(OutputSink& sink, const NumberFormat& format, size_t capacity)
+    : sink(sink), number_format(format), capacity(capacity) {
+    buffer.reserve(capacity + 512);
+}
+
+FigurePrinter::~FigurePrinter() {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+void FigurePrinter::print(size_t index, const Figure& figure) {
+    format(buffer, index, figure, number_format);
+    if (buffer.size() >= capacity) {
+        sink.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+void FigurePrinter::write(std::string_view text) {
+    buffer.append(text);
+    if (buffer.size() >= capacity) {
+        sink.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+void FigurePrinter::flush() {
+    if (!buffer.empty()) {
+        sink.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    sink.flush();
+}
+
+void FigurePrinter::format(std::string& out, size_t index, const Figure& figure,
+                           const NumberFormat& number_format) {
+    StringOut line{out, number_format};
+    line.text("Figure ");
+    number_format.append(out, index);
+    line.text(": ");
+    if (figure.type() == FigureType::Other) {
+        std::ostringstream s;
+        number_format.apply(s);
+        figure.print(s);
+        out += s.str();
+    } else {
+        describe(line, figure);
+    }
+    line.text(", Area: ");
+    line.number(figure.area());
+    line.text(", Center: (");
+    Point c = figure.center();
+    line.number(c.x);
+    line.text(", ");
+    line.number(c.y);
+    line.text(")\n");
+}
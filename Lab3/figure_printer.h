@@ -0,0 +1,91 @@
+#ifndef FIGURE_PRINTER_H
+#define FIGURE_PRINTER_H
+
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+#include <locale>
+#include <string>
+#include <string_view>
+#include "figure.h"
+
+// Destination for formatted output. Writes arrive in large blocks; a
+// sink that cannot take them throws.
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void flush() {}
+};
+
+class OstreamSink : public OutputSink {
+private:
+    std::ostream& os;
+
+public:
+    explicit OstreamSink(std::ostream& os) : os(os) {}
+    void write(const char* data, size_t size) override;
+    void flush() override;
+};
+
+class FileSink : public OutputSink {
+private:
+    std::FILE* file;
+
+public:
+    explicit FileSink(std::FILE* file) : file(file) {}
+    void write(const char* data, size_t size) override;
+    void flush() override;
+};
+
+// Number settings captured from a stream: float field, precision, the
+// flags that change how numbers look, and the locale. Numbers are written
+// with std::to_chars when that gives the same text the stream would, and
+// through a stream with these settings otherwise (e.g. hexfloat,
+// showpos, or a locale other than "C").
+class NumberFormat {
+private:
+    std::ios_base::fmtflags flags = std::ios_base::dec;
+    std::streamsize precision = 6;
+    std::locale locale = std::locale::classic();
+    std::chars_format style = std::chars_format::general;
+    bool direct = true;
+
+public:
+    NumberFormat() = default;
+    explicit NumberFormat(const std::ios_base& stream);
+
+    void append(std::string& out, double value) const;
+    void append(std::string& out, size_t value) const;
+    // Gives stream these settings, for text that has to go through one.
+    void apply(std::ios_base& stream) const;
+};
+
+// Formats figures into a reusable buffer and hands it to the sink whenever
+// it fills up. The text matches what operator<< writes to a stream with
+// the given number format.
+class FigurePrinter {
+private:
+    OutputSink& sink;
+    NumberFormat number_format;
+    std::string buffer;
+    size_t capacity;
+
+public:
+    explicit FigurePrinter(OutputSink& sink, const NumberFormat& format = NumberFormat(),
+                           size_t capacity = 1 << 16);
+    FigurePrinter(const FigurePrinter& other) = delete;
+    FigurePrinter& operator=(const FigurePrinter& other) = delete;
+    // Flushes what is left but swallows errors; call flush() to see them.
+    ~FigurePrinter();
+
+    void print(size_t index, const Figure& figure);
+    void write(std::string_view text);
+    void flush();
+
+    // Appends the line print_all writes for a figure, including '\n'.
+    static void format(std::string& out, size_t index, const Figure& figure,
+                       const NumberFormat& number_format = NumberFormat());
+};
+
+#endif
@@ -0,0 +1,177 @@
+#include "figure_snapshot.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "hexagon.h"
+#include "pentagon.h"
+#include "rhombus.h"
+
+namespace {
+
+const char snapshot_magic[4] = {'F', 'I', 'G', 'A'};
+const uint32_t byte_order_marker = 0x01020304;
+const size_t header_size = 16;
+
+size_t padded(size_t bytes) {
+    return (bytes + 7) / 8 * 8;
+}
+
+size_t expected_vertices(FigureType type) {
+    switch (type) {
+        case FigureType::Rhombus:
+            return 4;
+        case FigureType::Pentagon:
+            return 5;
+        case FigureType::Hexagon:
+            return 6;
+        case FigureType::Other:
+            break;
+    }
+    return 0;
+}
+
+template <typename T>
+void write_value(std::ostream& os, const T& value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}
+
+void write_snapshot(const FigureArray& array, std::ostream& os) {
+    uint64_t count = array.size();
+    if (array.count(FigureType::Other) != 0) {
+        throw std::invalid_argument("Snapshots store only the built-in figure types");
+    }
+    os.write(snapshot_magic, sizeof(snapshot_magic));
+    write_value(os, byte_order_marker);
+    write_value(os, count);
+
+    std::vector<char> tags(padded(count), 0);
+    for (size_t i = 0; i < count; ++i) {
+        tags[i] = static_cast<char>(array.at(i).type());
+    }
+    os.write(tags.data(), tags.size());
+
+    std::vector<uint64_t> offsets(count + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i + 1] = offsets[i] + array.at(i).vertex_count();
+    }
+    os.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+
+    std::vector<double> coords;
+    for (size_t i = 0; i < count; ++i) {
+        const Figure& figure = array.at(i);
+        coords.clear();
+        for (size_t v = 0; v < figure.vertex_count(); ++v) {
+            coords.push_back(figure.vertex(v).x);
+            coords.push_back(figure.vertex(v).y);
+        }
+        os.write(reinterpret_cast<const char*>(coords.data()), coords.size() * sizeof(double));
+    }
+    if (!os) {
+        throw std::runtime_error("Failed to write snapshot");
+    }
+}
+
+void write_snapshot(const FigureArray& array, const std::string& path) {
+    std::ofstream os(path, std::ios::binary);
+    if (!os) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    write_snapshot(array, os);
+}
+
+FigureSnapshot::FigureSnapshot(const std::string& path) : file(path) {
+    const char* data = file.data();
+    size_t size = file.size();
+    if (size < header_size || std::memcmp(data, snapshot_magic, sizeof(snapshot_magic)) != 0) {
+        throw std::runtime_error(path + " is not a figure snapshot");
+    }
+    uint32_t marker;
+    uint64_t n;
+    std::memcpy(&marker, data + 4, sizeof(marker));
+    std::memcpy(&n, data + 8, sizeof(n));
+    if (marker != byte_order_marker) {
+        throw std::runtime_error(path + " was written with a different byte order");
+    }
+
+    size_t tags_end = header_size + padded(n);
+    size_t offsets_end = tags_end + (n + 1) * sizeof(uint64_t);
+    if (n > size || offsets_end > size) {
+        throw std::runtime_error(path + " is truncated");
+    }
+    count = n;
+    tags = reinterpret_cast<const uint8_t*>(data + header_size);
+    offsets = reinterpret_cast<const uint64_t*>(data + tags_end);
+    vertex_total = offsets[count];
+    if (offsets[0] != 0 || vertex_total > (size - offsets_end) / (2 * sizeof(double))) {
+        throw std::runtime_error(path + " is truncated");
+    }
+    coords = reinterpret_cast<const double*>(data + offsets_end);
+}
+
+void FigureSnapshot::check_index(size_t i) const {
+    if (i >= count) {
+        throw std::out_of_range("Figure index out of range");
+    }
+    if (tags[i] >= static_cast<uint8_t>(FigureType::Other) || offsets[i] > offsets[i + 1] || offsets[i + 1] > vertex_total ||
+        offsets[i + 1] - offsets[i] != expected_vertices(static_cast<FigureType>(tags[i]))) {
+        throw std::runtime_error("Corrupt snapshot entry " + std::to_string(i));
+    }
+}
+
+size_t FigureSnapshot::size() const {
+    return count;
+}
+
+FigureType FigureSnapshot::type(size_t i) const {
+    check_index(i);
+    return static_cast<FigureType>(tags[i]);
+}
+
+size_t FigureSnapshot::vertex_count(size_t i) const {
+    check_index(i);
+    return offsets[i + 1] - offsets[i];
+}
+
+Point FigureSnapshot::vertex(size_t i, size_t v) const {
+    if (v >= vertex_count(i)) {
+        throw std::out_of_range("Vertex index out of range");
+    }
+    const double* p = coords + 2 * (offsets[i] + v);
+    return Point(p[0], p[1]);
+}
+
+const double* FigureSnapshot::coordinates(size_t i) const {
+    check_index(i);
+    return coords + 2 * offsets[i];
+}
+
+std::shared_ptr<Figure> FigureSnapshot::figure(size_t i) const {
+    const double* p = coordinates(i);
+    std::vector<Point> vertices(vertex_count(i));
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        vertices[v] = Point(p[2 * v], p[2 * v + 1]);
+    }
+    switch (static_cast<FigureType>(tags[i])) {
+        case FigureType::Rhombus:
+            return std::make_shared<Rhombus>(vertices);
+        case FigureType::Pentagon:
+            return std::make_shared<Pentagon>(vertices);
+        case FigureType::Hexagon:
+            return std::make_shared<Hexagon>(vertices);
+        case FigureType::Other:
+            break;
+    }
+    return nullptr;
+}
+
+FigureArray FigureSnapshot::to_array() const {
+    FigureArray array;
+    array.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        array.add(figure(i));
+    }
+    return array;
+}
@@ -0,0 +1,49 @@
+#ifndef FIGURE_SNAPSHOT_H
+#define FIGURE_SNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "figure.h"
+#include "figure_array.h"
+#include "mapped_file.h"
+
+// Snapshot layout, all values in native byte order:
+//     header   "FIGA", uint32 byte-order marker, uint64 figure count
+//     tags     one uint8 FigureType per figure, zero-padded to 8 bytes
+//     offsets  count + 1 uint64 vertex offsets, figure i owns vertices
+//              [offsets[i], offsets[i + 1])
+//     vertices x, y doubles
+// The sections are 8-byte aligned, so a mapped file is read in place.
+void write_snapshot(const FigureArray& array, std::ostream& os);
+void write_snapshot(const FigureArray& array, const std::string& path);
+
+// Memory-mapped snapshot. Opening checks only the header and the section
+// sizes; figures are decoded on access.
+class FigureSnapshot {
+private:
+    MappedFile file;
+    size_t count = 0;
+    const uint8_t* tags = nullptr;
+    const uint64_t* offsets = nullptr;
+    const double* coords = nullptr;
+    size_t vertex_total = 0;
+
+    void check_index(size_t i) const;
+
+public:
+    explicit FigureSnapshot(const std::string& path);
+
+    size_t size() const;
+    FigureType type(size_t i) const;
+    size_t vertex_count(size_t i) const;
+    Point vertex(size_t i, size_t v) const;
+
+    // Pointer to the 2 * vertex_count(i) interleaved coordinates of figure i.
+    const double* coordinates(size_t i) const;
+
+    std::shared_ptr<Figure> figure(size_t i) const;
+    FigureArray to_array() const;
+};
+
+#endif
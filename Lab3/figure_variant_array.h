@@ -0,0 +1,93 @@
+#ifndef FIGURE_VARIANT_ARRAY_H
+#define FIGURE_VARIANT_ARRAY_H
+
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "rhombus.h"
+#include "pentagon.h"
+#include "hexagon.h"
+
+using FigureVariant = std::variant<Rhombus, Pentagon, Hexagon>;
+
+// Stores figures by value in one contiguous vector. Calls are dispatched
+// with std::visit and qualified member names, so the concrete type is
+// known statically and no virtual call is made.
+class FigureVariantArray {
+private:
+    std::vector<FigureVariant> figures;
+
+public:
+    static double area_of(const FigureVariant& figure) {
+        return std::visit([](const auto& f) {
+            using T = std::decay_t<decltype(f)>;
+            return f.T::area();
+        }, figure);
+    }
+
+    static Point center_of(const FigureVariant& figure) {
+        return std::visit([](const auto& f) {
+            using T = std::decay_t<decltype(f)>;
+            return f.T::center();
+        }, figure);
+    }
+
+    void add(FigureVariant figure) {
+        figures.push_back(std::move(figure));
+    }
+
+    template <typename T, typename... Args>
+    void emplace(Args&&... args) {
+        figures.emplace_back(std::in_place_type<T>, std::forward<Args>(args)...);
+    }
+
+    void remove(size_t index) {
+        if (index < figures.size()) {
+            figures.erase(figures.begin() + index);
+        }
+    }
+
+    void reserve(size_t capacity) {
+        figures.reserve(capacity);
+    }
+
+    double total_area() const {
+        double total = 0;
+        for (const auto& figure : figures) {
+            total += area_of(figure);
+        }
+        return total;
+    }
+
+    void print_all() const {
+        for (size_t i = 0; i < figures.size(); ++i) {
+            Point c = center_of(figures[i]);
+            std::cout << "Figure " << i << ": ";
+            std::visit([](const auto& f) { std::cout << f; }, figures[i]);
+            std::cout << ", Area: " << area_of(figures[i])
+                      << ", Center: (" << c.x << ", " << c.y << ")" << std::endl;
+        }
+    }
+
+    size_t size() const {
+        return figures.size();
+    }
+
+    const FigureVariant* get(size_t index) const {
+        if (index < figures.size()) {
+            return &figures[index];
+        }
+        return nullptr;
+    }
+
+    template <typename F>
+    void for_each(F&& f) const {
+        for (const auto& figure : figures) {
+            std::visit(f, figure);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "mapped_file.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    address = buffer.data();
+    length = buffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path);
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length > 0) {
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + path);
+        }
+        ::madvise(p, length, MADV_SEQUENTIAL);
+        address = static_cast<const char*>(p);
+    }
+    ::close(fd);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : address(std::exchange(other.address, nullptr)), length(std::exchange(other.length, 0))
+#ifdef _WIN32
+    , buffer(std::move(other.buffer))
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        address = std::exchange(other.address, nullptr);
+        length = std::exchange(other.length, 0);
+#ifdef _WIN32
+        buffer = std::move(other.buffer);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::release() noexcept {
+#ifndef _WIN32
+    if (address) {
+        ::munmap(const_cast<char*>(address), length);
+    }
+#endif
+    address = nullptr;
+    length = 0;
+}
+
+const char* MappedFile::data() const {
+    return address;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+std::string_view MappedFile::view() const {
+    return std::string_view(address, length);
+}
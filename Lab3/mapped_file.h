@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only view of a whole file. On POSIX systems the file is mapped
+// into memory; elsewhere it is read into a buffer.
+class MappedFile {
+private:
+    const char* address = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+
+    void release() noexcept;
+
+public:
+    explicit MappedFile(const std::string& path);
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile& other) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    const char* data() const;
+    size_t size() const;
+    std::string_view view() const;
+};
+
+#endif
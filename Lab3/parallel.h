@@ -0,0 +1,170 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work is always cut into blocks of this many items, independent of the
+// number of threads, so per-block results combined in block order are
+// the same no matter how many threads ran.
+constexpr size_t parallel_block_size = 4096;
+
+// Every function taking a thread count defaults it to 0, which means one
+// thread per core; 1 runs serially on the calling thread.
+inline size_t resolve_thread_count(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    return threads;
+}
+
+inline size_t block_count(size_t n, size_t block = parallel_block_size) {
+    return (n + block - 1) / block;
+}
+
+// Helper threads shared by every parallel call in the process. They are
+// started on first use, grow to the largest number of helpers any call
+// asked for, and wait on a queue between calls.
+class ThreadPool {
+public:
+    // One parallel call. Helpers that pick it up after the caller has
+    // closed it skip it, so the caller only waits for helpers that actually
+    // started; when every helper is busy (e.g. a nested call) the caller
+    // simply does all the work itself.
+    struct Job {
+        std::function<void()> work;
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t active = 0;
+        bool closed = false;
+    };
+
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ThreadPool() = default;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Offers job to `helpers` helper threads.
+    void submit(const std::shared_ptr<Job>& job, size_t helpers) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (threads.size() < helpers) {
+                threads.emplace_back([this] { run(); });
+            }
+            for (size_t i = 0; i < helpers; ++i) {
+                queue.push_back(job);
+            }
+        }
+        ready.notify_all();
+    }
+
+    // Closes job to helpers that have not started it yet and waits for the
+    // ones that have.
+    static void close(Job& job) {
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.closed = true;
+        job.finished.wait(lock, [&] { return job.active == 0; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::shared_ptr<Job>> queue;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+
+    void run() {
+        for (;;) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&] { return stopping || !queue.empty(); });
+                if (stopping) {
+                    return;
+                }
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (job->closed) {
+                    continue;
+                }
+                ++job->active;
+            }
+            job->work();
+            std::lock_guard<std::mutex> lock(job->mutex);
+            if (--job->active == 0) {
+                job->finished.notify_all();
+            }
+        }
+    }
+};
+
+// Calls f(block_index, begin, end) for every block of [0, n). The caller
+// and up to threads - 1 pooled helpers take blocks from a shared counter;
+// the first exception thrown is rethrown once all of them are done.
+template <typename F>
+void parallel_blocks(size_t n, size_t threads, F f, size_t block = parallel_block_size) {
+    size_t blocks = block_count(n, block);
+    threads = std::min(resolve_thread_count(threads), std::max<size_t>(blocks, 1));
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        for (size_t b = next++; b < blocks; b = next++) {
+            try {
+                f(b, b * block, std::min(n, (b + 1) * block));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+                next = blocks;
+            }
+        }
+    };
+
+    if (threads > 1) {
+        auto job = std::make_shared<ThreadPool::Job>();
+        job->work = worker;
+        try {
+            ThreadPool::shared().submit(job, threads - 1);
+        } catch (...) {
+            ThreadPool::close(*job);
+            throw;
+        }
+        worker();
+        ThreadPool::close(*job);
+    } else {
+        worker();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif
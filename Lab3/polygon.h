@@ -0,0 +1,221 @@
+#ifndef POLYGON_H
+#define POLYGON_H
+
+#include "figure.h"
+#include "affine.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <size_t N>
+struct PolygonTraits;
+
+template <>
+struct PolygonTraits<5> {
+    static constexpr FigureType type = FigureType::Pentagon;
+    static constexpr const char* name = "Pentagon";
+};
+
+template <>
+struct PolygonTraits<6> {
+    static constexpr FigureType type = FigureType::Hexagon;
+    static constexpr const char* name = "Hexagon";
+};
+
+// Simple polygon with N vertices stored inline. The area is computed with
+// the shoelace formula, expanded at compile time over the vertex pairs, so
+// it is exact for any vertex order and any (non-self-intersecting) shape.
+// Pentagon and Hexagon are aliases of Polygon<5> and Polygon<6>; the
+// center/radius constructor builds a regular one, but nothing keeps it so.
+template <size_t N>
+class Polygon : public Figure {
+private:
+    std::array<Point, N> vertices;
+
+    // Computed in update_cache(); apply() maps them along with the vertices.
+    double cached_area;
+    Point cached_center;
+
+    template <size_t... I>
+    static double shoelace(const std::array<Point, N>& v, std::index_sequence<I...>) {
+        return ((v[I].x * v[(I + 1) % N].y - v[(I + 1) % N].x * v[I].y) + ...);
+    }
+
+protected:
+    void update_cache() {
+        double x = 0, y = 0;
+        for (const auto& vertex : vertices) {
+            x += vertex.x;
+            y += vertex.y;
+        }
+        cached_center = Point(x / N, y / N);
+        cached_area = 0.5 * std::abs(shoelace(vertices, std::make_index_sequence<N>()));
+    }
+
+public:
+    static_assert(N >= 3, "A polygon needs at least 3 vertices");
+
+    Polygon()
+        : Figure(PolygonTraits<N>::type), vertices(), cached_area(0), cached_center() {
+        update_cache();
+    }
+
+    Polygon(const std::array<Point, N>& vertices)
+        : Figure(PolygonTraits<N>::type), vertices(vertices), cached_area(0), cached_center() {
+        update_cache();
+    }
+
+    Polygon(const Point& center, double radius)
+        : Figure(PolygonTraits<N>::type), vertices(), cached_area(0), cached_center() {
+        for (size_t i = 0; i < N; ++i) {
+            double angle = 2 * M_PI * i / N;
+            this->vertices[i] = Point(center.x + radius * std::cos(angle),
+                                      center.y + radius * std::sin(angle));
+        }
+        update_cache();
+    }
+
+    Polygon(const std::vector<Point>& vertices)
+        : Figure(PolygonTraits<N>::type), vertices(), cached_area(0), cached_center() {
+        if (vertices.size() != N) {
+            throw std::invalid_argument(std::string(PolygonTraits<N>::name) + " must have exactly " +
+                                        std::to_string(N) + " vertices");
+        }
+        std::copy(vertices.begin(), vertices.end(), this->vertices.begin());
+        update_cache();
+    }
+
+    Polygon(const Polygon& other) = default;
+    Polygon(Polygon&& other) noexcept = default;
+    Polygon& operator=(const Polygon& other) = default;
+    Polygon& operator=(Polygon&& other) noexcept = default;
+    ~Polygon() override = default;
+
+    Point center() const override {
+        return cached_center;
+    }
+
+    double area() const override {
+        return cached_area;
+    }
+
+    void read(std::istream& is) override {
+        for (size_t i = 0; i < N; ++i) {
+            is >> vertices[i].x >> vertices[i].y;
+        }
+        update_cache();
+    }
+
+    size_t vertex_count() const override {
+        return N;
+    }
+
+    const Point& vertex(size_t i) const override {
+        return vertices.at(i);
+    }
+
+    // Any affine map scales the shoelace area by |det|.
+    void apply(const Affine& t) override {
+        t.apply(vertices.data(), N);
+        cached_center = t.apply(cached_center);
+        cached_area *= std::abs(t.determinant());
+    }
+
+    std::shared_ptr<Figure> clone() const override {
+        return std::make_shared<Polygon>(*this);
+    }
+
+    std::shared_ptr<Figure> clone(const PoolAllocator<Figure>& alloc) const override {
+        return std::allocate_shared<Polygon>(PoolAllocator<Polygon>(alloc), *this);
+    }
+
+    bool equals(const Figure& other) const override {
+        // The tag identifies N, so a matching tag means other is a Polygon<N>.
+        if (other.type() != PolygonTraits<N>::type) return false;
+        const Polygon& otherPolygon = static_cast<const Polygon&>(other);
+
+        for (size_t i = 0; i < N; ++i) {
+            if (!(vertices[i] == otherPolygon.vertices[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Opt-in checked variant of Polygon<N> that stays regular: every vertex at
+// the same distance from the center and every side 2R sin(pi/N), within
+// regular_polygon_tolerance times max(R, 1). Vertices from outside are
+// checked, read() sets failbit on input that is not regular, and only
+// similarities may be applied. The tolerance is far below the default
+// stream precision, so text input needs full precision (max_digits10).
+constexpr double regular_polygon_tolerance = 1e-9;
+
+template <size_t N>
+class RegularPolygon : public Polygon<N> {
+private:
+    bool is_regular() const {
+        Point c = this->center();
+        double radius = std::hypot(this->vertex(0).x - c.x, this->vertex(0).y - c.y);
+        double side = 2 * radius * std::sin(M_PI / N);
+        double tolerance = regular_polygon_tolerance * std::max(radius, 1.0);
+        for (size_t i = 0; i < N; ++i) {
+            const Point& a = this->vertex(i);
+            const Point& b = this->vertex((i + 1) % N);
+            if (std::abs(std::hypot(a.x - c.x, a.y - c.y) - radius) > tolerance ||
+                std::abs(std::hypot(b.x - a.x, b.y - a.y) - side) > tolerance) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    RegularPolygon() = default;
+
+    RegularPolygon(const Point& center, double radius) : Polygon<N>(center, radius) {}
+
+    RegularPolygon(const std::vector<Point>& vertices) : Polygon<N>(vertices) {
+        if (!is_regular()) {
+            throw std::invalid_argument(std::string("Vertices do not form a regular ") +
+                                        PolygonTraits<N>::name);
+        }
+    }
+
+    // Keeps the previous vertices and sets failbit if the input is not
+    // regular.
+    void read(std::istream& is) override {
+        Polygon<N> previous = *this;
+        Polygon<N>::read(is);
+        if (is && !is_regular()) {
+            Polygon<N>::operator=(previous);
+            is.setstate(std::ios::failbit);
+        }
+    }
+
+    bool accepts(const Affine& t) const override {
+        return t.is_similarity();
+    }
+
+    void apply(const Affine& t) override {
+        if (!accepts(t)) {
+            throw std::invalid_argument(std::string("Only a similarity keeps a ") +
+                                        PolygonTraits<N>::name + " regular");
+        }
+        Polygon<N>::apply(t);
+    }
+
+    std::shared_ptr<Figure> clone() const override {
+        return std::make_shared<RegularPolygon>(*this);
+    }
+
+    std::shared_ptr<Figure> clone(const PoolAllocator<Figure>& alloc) const override {
+        return std::allocate_shared<RegularPolygon>(PoolAllocator<RegularPolygon>(alloc), *this);
+    }
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Allocator over a shared memory resource. Every allocation holds a
+// reference to the resource (via the allocator copy that shared_ptr keeps
+// in its control block), so the resource lives until the last object
+// allocated from it is gone, even if its original owner is destroyed first.
+template <typename T>
+class PoolAllocator {
+private:
+    template <typename U>
+    friend class PoolAllocator;
+
+    std::shared_ptr<std::pmr::memory_resource> resource;
+
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(std::shared_ptr<std::pmr::memory_resource> resource)
+        : resource(std::move(resource)) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : resource(other.resource) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        resource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    std::pmr::memory_resource* memory_resource() const {
+        return resource.get();
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const {
+        return resource == other.resource;
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const {
+        return !(*this == other);
+    }
+};
+
+#endif
@@ -1,30 +1,44 @@
 #include "rhombus.h"
+#include "affine.h"
 #include <iostream>
 #include <cmath>
 #include <stdexcept>
+#include <algorithm>
 
-Rhombus::Rhombus() : vertices(4) {}
+Rhombus::Rhombus()
+    : Figure(FigureType::Rhombus), vertices(), cached_area(0), cached_center() {
+    update_cache();
+}
 
-Rhombus::Rhombus(const Point& center, double diagonal1, double diagonal2) : vertices(4) {
+Rhombus::Rhombus(const Point& center, double diagonal1, double diagonal2)
+    : Figure(FigureType::Rhombus), vertices(), cached_area(0), cached_center() {
     vertices[0] = Point(center.x, center.y + diagonal2/2);
     vertices[1] = Point(center.x + diagonal1/2, center.y);
     vertices[2] = Point(center.x, center.y - diagonal2/2);
     vertices[3] = Point(center.x - diagonal1/2, center.y);
+    update_cache();
 }
 
-Rhombus::Rhombus(const std::vector<Point>& vertices) : vertices(vertices) {
+Rhombus::Rhombus(const std::vector<Point>& vertices)
+    : Figure(FigureType::Rhombus), vertices(), cached_area(0), cached_center() {
     if (vertices.size() != 4) {
         throw std::invalid_argument("Rhombus must have exactly 4 vertices");
     }
+    std::copy(vertices.begin(), vertices.end(), this->vertices.begin());
+    update_cache();
 }
 
-Rhombus::Rhombus(const Rhombus& other) : vertices(other.vertices) {}
+Rhombus::Rhombus(const Rhombus& other)
+    : Figure(other), vertices(other.vertices), cached_area(other.cached_area), cached_center(other.cached_center) {}
 
-Rhombus::Rhombus(Rhombus&& other) noexcept : vertices(std::move(other.vertices)) {}
+Rhombus::Rhombus(Rhombus&& other) noexcept
+    : Figure(other), vertices(std::move(other.vertices)), cached_area(other.cached_area), cached_center(other.cached_center) {}
 
 Rhombus& Rhombus::operator=(const Rhombus& other) {
     if (this != &other) {
         vertices = other.vertices;
+        cached_area = other.cached_area;
+        cached_center = other.cached_center;
     }
     return *this;
 }
@@ -32,52 +46,71 @@ Rhombus& Rhombus::operator=(const Rhombus& other) {
 Rhombus& Rhombus::operator=(Rhombus&& other) noexcept {
     if (this != &other) {
         vertices = std::move(other.vertices);
+        cached_area = other.cached_area;
+        cached_center = other.cached_center;
     }
     return *this;
 }
 
-Point Rhombus::center() const {
+void Rhombus::update_cache() {
     double x = 0, y = 0;
     for (const auto& vertex : vertices) {
         x += vertex.x;
         y += vertex.y;
     }
-    return Point(x / 4, y / 4);
+    cached_center = Point(x / 4, y / 4);
+    // Half the cross product of the diagonals: the shoelace area of any
+    // simple quadrilateral, and d1 * d2 / 2 while it is a rhombus.
+    double ax = vertices[2].x - vertices[0].x, ay = vertices[2].y - vertices[0].y;
+    double bx = vertices[3].x - vertices[1].x, by = vertices[3].y - vertices[1].y;
+    cached_area = std::abs(ax * by - ay * bx) / 2;
 }
 
-double Rhombus::area() const {
-    double d1 = std::sqrt(std::pow(vertices[0].x - vertices[2].x, 2) + 
-                         std::pow(vertices[0].y - vertices[2].y, 2));
-    double d2 = std::sqrt(std::pow(vertices[1].x - vertices[3].x, 2) + 
-                         std::pow(vertices[1].y - vertices[3].y, 2));
-    return (d1 * d2) / 2;
+Point Rhombus::center() const {
+    return cached_center;
 }
 
-void Rhombus::print(std::ostream& os) const {
-    os << "Rhombus vertices: ";
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        os << "(" << vertices[i].x << ", " << vertices[i].y << ")";
-        if (i != vertices.size() - 1) os << " ";
-    }
+double Rhombus::area() const {
+    return cached_area;
 }
 
 void Rhombus::read(std::istream& is) {
-    vertices.resize(4);
     for (int i = 0; i < 4; ++i) {
         is >> vertices[i].x >> vertices[i].y;
     }
+    update_cache();
+}
+
+size_t Rhombus::vertex_count() const {
+    return vertices.size();
+}
+
+const Point& Rhombus::vertex(size_t i) const {
+    return vertices.at(i);
+}
+
+// Any affine map scales the area by |det|; a non-similarity leaves a
+// parallelogram, whose area the same formula still gives.
+void Rhombus::apply(const Affine& t) {
+    t.apply(vertices.data(), vertices.size());
+    cached_center = t.apply(cached_center);
+    cached_area *= std::abs(t.determinant());
 }
 
 std::shared_ptr<Figure> Rhombus::clone() const {
     return std::make_shared<Rhombus>(*this);
 }
 
-bool Rhombus::operator==(const Figure& other) const {
-    const Rhombus* otherRhombus = dynamic_cast<const Rhombus*>(&other);
-    if (!otherRhombus) return false;
+std::shared_ptr<Figure> Rhombus::clone(const PoolAllocator<Figure>& alloc) const {
+    return std::allocate_shared<Rhombus>(PoolAllocator<Rhombus>(alloc), *this);
+}
+
+bool Rhombus::equals(const Figure& other) const {
+    if (other.type() != FigureType::Rhombus) return false;
+    const Rhombus& otherRhombus = static_cast<const Rhombus&>(other);
     
     for (size_t i = 0; i < vertices.size(); ++i) {
-        if (!(vertices[i] == otherRhombus->vertices[i])) {
+        if (!(vertices[i] == otherRhombus.vertices[i])) {
             return false;
         }
     }
@@ -2,11 +2,18 @@
 #define RHOMBUS_H
 
 #include "figure.h"
+#include <array>
 #include <vector>
 
 class Rhombus : public Figure {
 private:
-    std::vector<Point> vertices;
+    std::array<Point, 4> vertices;
+
+    // Set by update_cache() and apply().
+    double cached_area;
+    Point cached_center;
+
+    void update_cache();
     
 public:
     Rhombus();
@@ -21,11 +28,15 @@ public:
     
     Point center() const override;
     double area() const override;
-    void print(std::ostream& os) const override;
     void read(std::istream& is) override;
+
+    size_t vertex_count() const override;
+    const Point& vertex(size_t i) const override;
+    void apply(const Affine& t) override;
     
     std::shared_ptr<Figure> clone() const override;
-    bool operator==(const Figure& other) const override;
+    std::shared_ptr<Figure> clone(const PoolAllocator<Figure>& alloc) const override;
+    bool equals(const Figure& other) const override;
     
     double get_diagonal1() const;
     double get_diagonal2() const;
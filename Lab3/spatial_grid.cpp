@@ -0,0 +1,243 @@
+#include "spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+bool intersects(const BoundingBox& a, const BoundingBox& b) {
+    return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+           a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+}
+
+SpatialGrid::SpatialGrid(double cell_size) : cell(cell_size) {
+    if (!(cell_size > 0) || !std::isfinite(cell_size)) {
+        throw std::invalid_argument("Cell size must be positive");
+    }
+}
+
+double SpatialGrid::cell_size() const {
+    return cell;
+}
+
+size_t SpatialGrid::size() const {
+    return live_count;
+}
+
+int64_t SpatialGrid::cell_coord(double v) const {
+    double c = std::floor(v / cell);
+    const double limit = 1e9;
+    return static_cast<int64_t>(std::max(-limit, std::min(limit, c)));
+}
+
+SpatialGrid::CellRange SpatialGrid::cells_of(const BoundingBox& box) const {
+    return CellRange{cell_coord(box.min.x), cell_coord(box.min.y),
+                     cell_coord(box.max.x), cell_coord(box.max.y)};
+}
+
+uint64_t SpatialGrid::key(int64_t cx, int64_t cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) |
+           static_cast<uint32_t>(cy);
+}
+
+void SpatialGrid::insert(FigureHandle handle, const BoundingBox& box, const Point& center) {
+    if (handle.slot >= entries.size()) {
+        entries.resize(handle.slot + 1);
+    }
+    Entry& entry = entries[handle.slot];
+    if (entry.live) {
+        erase(entry.handle);
+    }
+    CellRange r = cells_of(box);
+    double span = double(r.x1 - r.x0 + 1) * double(r.y1 - r.y0 + 1);
+    entry = Entry{handle, box, center, true, span > max_cells_per_figure};
+    ++live_count;
+    if (entry.overflow) {
+        overflow.push_back(handle.slot);
+        return;
+    }
+
+    for (int64_t cx = r.x0; cx <= r.x1; ++cx) {
+        for (int64_t cy = r.y0; cy <= r.y1; ++cy) {
+            cells[key(cx, cy)].push_back(handle.slot);
+        }
+    }
+    if (!has_extents) {
+        min_cx = r.x0; min_cy = r.y0; max_cx = r.x1; max_cy = r.y1;
+        has_extents = true;
+    } else {
+        min_cx = std::min(min_cx, r.x0);
+        min_cy = std::min(min_cy, r.y0);
+        max_cx = std::max(max_cx, r.x1);
+        max_cy = std::max(max_cy, r.y1);
+    }
+}
+
+void SpatialGrid::erase(FigureHandle handle) {
+    if (handle.slot >= entries.size()) return;
+    Entry& entry = entries[handle.slot];
+    if (!entry.live || entry.handle != handle) return;
+    entry.live = false;
+    --live_count;
+    if (entry.overflow) {
+        auto pos = std::find(overflow.begin(), overflow.end(), handle.slot);
+        *pos = overflow.back();
+        overflow.pop_back();
+        return;
+    }
+
+    CellRange r = cells_of(entry.box);
+    for (int64_t cx = r.x0; cx <= r.x1; ++cx) {
+        for (int64_t cy = r.y0; cy <= r.y1; ++cy) {
+            auto it = cells.find(key(cx, cy));
+            if (it == cells.end()) continue;
+            std::vector<uint32_t>& slots = it->second;
+            auto pos = std::find(slots.begin(), slots.end(), handle.slot);
+            if (pos != slots.end()) {
+                *pos = slots.back();
+                slots.pop_back();
+            }
+            if (slots.empty()) cells.erase(it);
+        }
+    }
+}
+
+void SpatialGrid::clear() {
+    cells.clear();
+    entries.clear();
+    overflow.clear();
+    live_count = 0;
+    has_extents = false;
+}
+
+// A figure spanning several cells is reported only from the first cell it
+// shares with the region, so no de-duplication set is needed.
+std::vector<FigureHandle> SpatialGrid::query(const BoundingBox& region) const {
+    std::vector<FigureHandle> result;
+    for (uint32_t slot : overflow) {
+        if (intersects(entries[slot].box, region)) result.push_back(entries[slot].handle);
+    }
+    CellRange r = cells_of(region);
+
+    auto visit = [&](int64_t cx, int64_t cy, const std::vector<uint32_t>& slots) {
+        for (uint32_t slot : slots) {
+            const Entry& e = entries[slot];
+            if (!intersects(e.box, region)) continue;
+            CellRange er = cells_of(e.box);
+            if (cx != std::max(r.x0, er.x0) || cy != std::max(r.y0, er.y0)) continue;
+            result.push_back(e.handle);
+        }
+    };
+
+    double span = double(r.x1 - r.x0 + 1) * double(r.y1 - r.y0 + 1);
+    if (span > double(cells.size())) {
+        for (const auto& [k, slots] : cells) {
+            int64_t cx = static_cast<int32_t>(k >> 32);
+            int64_t cy = static_cast<int32_t>(k & 0xffffffffu);
+            if (cx >= r.x0 && cx <= r.x1 && cy >= r.y0 && cy <= r.y1) {
+                visit(cx, cy, slots);
+            }
+        }
+    } else {
+        for (int64_t cx = r.x0; cx <= r.x1; ++cx) {
+            for (int64_t cy = r.y0; cy <= r.y1; ++cy) {
+                auto it = cells.find(key(cx, cy));
+                if (it != cells.end()) visit(cx, cy, it->second);
+            }
+        }
+    }
+    return result;
+}
+
+// Searches square rings of cells around p. A figure is considered only in
+// the cell holding its center; after ring r every unseen center is at
+// least r cells away, which bounds when the search can stop. Overflow
+// figures are all considered up front.
+std::vector<FigureHandle> SpatialGrid::nearest(const Point& p, size_t k) const {
+    if (k == 0 || live_count == 0) return {};
+    if (k >= live_count || cells.empty()) return nearest_linear(p, k);
+
+    int64_t pcx = cell_coord(p.x);
+    int64_t pcy = cell_coord(p.y);
+
+    std::priority_queue<std::pair<double, uint32_t>> best;
+    auto consider = [&](uint32_t slot) {
+        const Entry& e = entries[slot];
+        double dx = e.center.x - p.x;
+        double dy = e.center.y - p.y;
+        double d2 = dx * dx + dy * dy;
+        if (best.size() < k) {
+            best.emplace(d2, slot);
+        } else if (d2 < best.top().first) {
+            best.pop();
+            best.emplace(d2, slot);
+        }
+    };
+    size_t visited = 0;
+    auto visit = [&](int64_t cx, int64_t cy) {
+        ++visited;
+        auto it = cells.find(key(cx, cy));
+        if (it == cells.end()) return;
+        for (uint32_t slot : it->second) {
+            const Entry& e = entries[slot];
+            if (cell_coord(e.center.x) != cx || cell_coord(e.center.y) != cy) continue;
+            consider(slot);
+        }
+    };
+
+    for (uint32_t slot : overflow) {
+        consider(slot);
+    }
+
+    int64_t start = std::max<int64_t>({0, min_cx - pcx, pcx - max_cx, min_cy - pcy, pcy - max_cy});
+    for (int64_t r = start;; ++r) {
+        if (r == 0) {
+            visit(pcx, pcy);
+        } else {
+            for (int64_t cx = pcx - r; cx <= pcx + r; ++cx) {
+                visit(cx, pcy - r);
+                visit(cx, pcy + r);
+            }
+            for (int64_t cy = pcy - r + 1; cy <= pcy + r - 1; ++cy) {
+                visit(pcx - r, cy);
+                visit(pcx + r, cy);
+            }
+        }
+
+        double reach = double(r) * cell;
+        if (best.size() == k && best.top().first <= reach * reach) break;
+        if (pcx - r <= min_cx && pcx + r >= max_cx && pcy - r <= min_cy && pcy + r >= max_cy) break;
+        if (visited > cells.size()) return nearest_linear(p, k);
+    }
+
+    std::vector<FigureHandle> result(best.size());
+    for (size_t i = result.size(); i-- > 0;) {
+        result[i] = entries[best.top().second].handle;
+        best.pop();
+    }
+    return result;
+}
+
+std::vector<FigureHandle> SpatialGrid::nearest_linear(const Point& p, size_t k) const {
+    std::vector<std::pair<double, uint32_t>> by_distance;
+    by_distance.reserve(live_count);
+    for (uint32_t slot = 0; slot < entries.size(); ++slot) {
+        const Entry& e = entries[slot];
+        if (!e.live) continue;
+        double dx = e.center.x - p.x;
+        double dy = e.center.y - p.y;
+        by_distance.emplace_back(dx * dx + dy * dy, slot);
+    }
+    k = std::min(k, by_distance.size());
+    std::partial_sort(by_distance.begin(), by_distance.begin() + k, by_distance.end());
+
+    std::vector<FigureHandle> result(k);
+    for (size_t i = 0; i < k; ++i) {
+        result[i] = entries[by_distance[i].second].handle;
+    }
+    return result;
+}
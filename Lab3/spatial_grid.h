@@ -0,0 +1,65 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "figure.h"
+#include "figure_handle.h"
+
+// Uniform hash grid over figure bounding boxes. Every figure is listed in
+// each cell its box overlaps, so the cell size should be on the order of
+// a typical figure; range queries then touch only the cells of the
+// region and nearest-neighbour queries search outward ring by ring.
+// Figures covering more than max_cells_per_figure cells are kept in a
+// separate overflow list that every query checks directly.
+class SpatialGrid {
+private:
+    struct Entry {
+        FigureHandle handle;
+        BoundingBox box;
+        Point center;
+        bool live = false;
+        bool overflow = false;
+    };
+
+    struct CellRange {
+        int64_t x0, y0, x1, y1;
+    };
+
+    double cell;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> overflow;
+    size_t live_count = 0;
+    // Cell range of the figures stored in cells; never shrinks on erase.
+    bool has_extents = false;
+    int64_t min_cx = 0, min_cy = 0, max_cx = -1, max_cy = -1;
+
+    int64_t cell_coord(double v) const;
+    CellRange cells_of(const BoundingBox& box) const;
+    static uint64_t key(int64_t cx, int64_t cy);
+    std::vector<FigureHandle> nearest_linear(const Point& p, size_t k) const;
+
+public:
+    static constexpr double max_cells_per_figure = 64;
+
+    explicit SpatialGrid(double cell_size);
+
+    double cell_size() const;
+    size_t size() const;
+
+    void insert(FigureHandle handle, const BoundingBox& box, const Point& center);
+    void erase(FigureHandle handle);
+    void clear();
+
+    // Figures whose bounding box intersects the region.
+    std::vector<FigureHandle> query(const BoundingBox& region) const;
+
+    // Up to k figures ordered by distance from their center to p. Falls
+    // back to a scan of all figures once the rings have covered more cells
+    // than are occupied, so sparse data costs O(n) at worst.
+    std::vector<FigureHandle> nearest(const Point& p, size_t k) const;
+};
+
+#endif
@@ -1,11 +1,30 @@
 #include <gtest/gtest.h>
 #include <sstream>
 #include <memory>
+#include <atomic>
+#include <algorithm>
+#include <random>
+#include <ranges>
+#include <numeric>
+#include <fstream>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <deque>
 #include "figure.h"
 #include "rhombus.h"
 #include "pentagon.h"
 #include "hexagon.h"
 #include "figure_array.h"
+#include "figure_variant_array.h"
+#include "figure_columns.h"
+#include "collision.h"
+#include "figure_loader.h"
+#include "figure_snapshot.h"
+#include "affine.h"
+#include "concurrent_figure_array.h"
+#include <set>
+#include <thread>
 
 TEST(PointTest, EqualityOperator) {
     Point p1(1.0, 2.0);
@@ -224,6 +243,1305 @@ TEST(InputTest, StreamOperators) {
     EXPECT_FALSE(ss.str().empty());
 }
 
+TEST(FigureVariantArrayTest, AddAndTotalArea) {
+    FigureVariantArray array;
+    array.add(Rhombus(Point(0, 0), 4, 6));
+    array.emplace<Pentagon>(Point(1, 1), 5);
+    array.emplace<Hexagon>(Point(-1, 2), 3);
+
+    EXPECT_EQ(array.size(), 3);
+
+    double expected = Rhombus(Point(0, 0), 4, 6).area()
+                    + Pentagon(Point(1, 1), 5).area()
+                    + Hexagon(Point(-1, 2), 3).area();
+    EXPECT_NEAR(array.total_area(), expected, 1e-9);
+}
+
+TEST(FigureVariantArrayTest, GetAndRemove) {
+    FigureVariantArray array;
+    array.add(Rhombus(Point(0, 0), 4, 6));
+    array.add(Hexagon(Point(2, 3), 1));
+
+    ASSERT_NE(array.get(1), nullptr);
+    EXPECT_TRUE(std::holds_alternative<Hexagon>(*array.get(1)));
+    Point c = FigureVariantArray::center_of(*array.get(1));
+    EXPECT_NEAR(c.x, 2.0, 1e-9);
+    EXPECT_NEAR(c.y, 3.0, 1e-9);
+    EXPECT_EQ(array.get(2), nullptr);
+
+    array.remove(0);
+    EXPECT_EQ(array.size(), 1);
+    EXPECT_TRUE(std::holds_alternative<Hexagon>(*array.get(0)));
+    EXPECT_NO_THROW(array.remove(10));
+}
+
+TEST(FigureVariantArrayTest, ForEachVisitsConcreteTypes) {
+    FigureVariantArray array;
+    array.emplace<Rhombus>(Point(0, 0), 2, 2);
+    array.emplace<Pentagon>(Point(0, 0), 1);
+    array.emplace<Pentagon>(Point(0, 0), 2);
+
+    int pentagons = 0;
+    array.for_each([&](const auto& f) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(f)>, Pentagon>) {
+            ++pentagons;
+        }
+    });
+    EXPECT_EQ(pentagons, 2);
+}
+
+TEST(FigureColumnsTest, AreasMatchFigures) {
+    FigureColumns columns;
+    double rhombi = 0, pentagons = 0, hexagons = 0;
+    for (int i = 0; i < 11; ++i) {
+        Rhombus r(Point(i, -i), 1 + i, 2 + i);
+        Pentagon p(Point(i, 2 * i), 0.5 + i);
+        Hexagon h(Point(-i, i), 1.5 + i);
+        columns.add(r);
+        columns.add(static_cast<const Figure&>(p));
+        if (i % 2 == 0) {
+            columns.add(h);
+            hexagons += h.area();
+        }
+        rhombi += r.area();
+        pentagons += p.area();
+    }
+
+    EXPECT_EQ(columns.rhombus_count(), 11);
+    EXPECT_EQ(columns.pentagon_count(), 11);
+    EXPECT_EQ(columns.hexagon_count(), 6);
+    EXPECT_EQ(columns.size(), 28);
+    EXPECT_NEAR(columns.rhombus_area(), rhombi, 1e-9);
+    EXPECT_NEAR(columns.pentagon_area(), pentagons, 1e-9);
+    EXPECT_NEAR(columns.hexagon_area(), hexagons, 1e-9);
+    EXPECT_NEAR(columns.total_area(), rhombi + pentagons + hexagons, 1e-9);
+}
+
+TEST(FigureColumnsTest, CentersMatchFigures) {
+    FigureColumns columns;
+    std::vector<Hexagon> hexagons;
+    for (int i = 0; i < 5; ++i) {
+        hexagons.emplace_back(Point(i * 1.5, 3 - i), 2);
+        columns.add(hexagons.back());
+    }
+
+    CenterColumns centers = columns.hexagon_centers();
+    ASSERT_EQ(centers.x.size(), hexagons.size());
+    for (size_t i = 0; i < hexagons.size(); ++i) {
+        EXPECT_NEAR(centers.x[i], hexagons[i].center().x, 1e-9);
+        EXPECT_NEAR(centers.y[i], hexagons[i].center().y, 1e-9);
+    }
+    EXPECT_TRUE(columns.rhombus_centers().x.empty());
+}
+
+TEST(CacheTest, ReadInvalidatesCachedValues) {
+    Rhombus rhombus(Point(0, 0), 4, 6);
+    EXPECT_NEAR(rhombus.area(), 12.0, 1e-9);
+    EXPECT_NEAR(rhombus.center().x, 0.0, 1e-9);
+
+    std::stringstream ss("10 3 12 0 10 -3 8 0");
+    ss >> rhombus;
+    EXPECT_NEAR(rhombus.area(), 12.0, 1e-9);
+    EXPECT_NEAR(rhombus.center().x, 10.0, 1e-9);
+
+    Hexagon hexagon(Point(0, 0), 1);
+    double small = hexagon.area();
+    std::stringstream hs("2 0 1 1.7320508075688772 -1 1.7320508075688772 -2 0 -1 -1.7320508075688772 1 -1.7320508075688772");
+    hs >> hexagon;
+    EXPECT_NEAR(hexagon.area(), 4 * small, 1e-9);
+}
+
+TEST(PolygonTest, RegularPolygonRejectsIrregularInput) {
+    std::vector<Point> house{Point(0, 0), Point(4, 0), Point(4, 3), Point(2, 5), Point(0, 3)};
+    EXPECT_THROW(RegularPolygon<5>{house}, std::invalid_argument);
+    RegularPolygon<5> regular(Point(1, 2), 3);
+    std::vector<Point> vertices(regular.vertex_count());
+    for (size_t i = 0; i < vertices.size(); ++i) vertices[i] = regular.vertex(i);
+    EXPECT_EQ(RegularPolygon<5>(vertices).area(), regular.area());
+
+    std::stringstream ss("0 0 4 0 4 3 2 5 0 3");
+    ss >> regular;
+    EXPECT_TRUE(ss.fail());
+    EXPECT_TRUE(regular == Pentagon(Point(1, 2), 3));
+
+    Affine shear{1, 1, 0, 0, 1, 0};
+    EXPECT_FALSE(regular.accepts(shear));
+    EXPECT_THROW(regular.apply(shear), std::invalid_argument);
+    FigureArray array;
+    array.add(std::make_shared<Rhombus>(Point(0, 0), 2, 2));
+    array.add(std::make_shared<RegularPolygon<5>>(regular));
+    EXPECT_THROW(array.transform(shear), std::invalid_argument);
+    EXPECT_NEAR(array.at(0).vertex(1).x, 1.0, 1e-12);
+}
+
+TEST(PolygonTest, PentagonReadsItsOwnOutput) {
+    // Coordinates at the default six significant digits, as operator<<
+    // writes them.
+    Pentagon pentagon(Point(0, 0), 5);
+    std::stringstream ss;
+    for (size_t i = 0; i < pentagon.vertex_count(); ++i) {
+        ss << pentagon.vertex(i).x << ' ' << pentagon.vertex(i).y << ' ';
+    }
+    Pentagon parsed;
+    ss >> parsed;
+    EXPECT_FALSE(ss.fail());
+    EXPECT_NEAR(parsed.area(), pentagon.area(), 1e-3);
+    EXPECT_NEAR(parsed.vertex(1).x, pentagon.vertex(1).x, 1e-5);
+
+    Pentagon house(std::vector<Point>{Point(0, 0), Point(4, 0), Point(4, 3), Point(2, 5), Point(0, 3)});
+    EXPECT_NEAR(house.area(), 16.0, 1e-12);
+    Affine shear{1, 1, 0, 0, 1, 0};
+    EXPECT_TRUE(house.accepts(shear));
+
+    FigureArray loaded = parse_figures("pentagon 0 0 4 0 4 3 2 5 0 3\n");
+    FigureVariantArray values;
+    values.add(static_cast<const Pentagon&>(loaded.at(0)));
+    EXPECT_NEAR(values.total_area(), 16.0, 1e-12);
+}
+
+TEST(CacheTest, AssignmentReplacesCachedValues) {
+    Pentagon small(Point(0, 0), 1);
+    Pentagon large(Point(5, 5), 2);
+    double small_area = small.area();
+    double large_area = large.area();
+
+    small = large;
+    EXPECT_NEAR(small.area(), large_area, 1e-9);
+    EXPECT_NEAR(small.center().x, 5.0, 1e-9);
+
+    Pentagon fresh(Point(0, 0), 1);
+    large = std::move(fresh);
+    EXPECT_NEAR(large.area(), small_area, 1e-9);
+    EXPECT_NEAR(large.center().x, 0.0, 1e-9);
+}
+
+TEST(CacheTest, SharedFigureReadConcurrently) {
+    auto hexagon = std::make_shared<Hexagon>(Point(1, 1), 2);
+    FigureArray array;
+    for (int i = 0; i < 10000; ++i) {
+        array.add(hexagon);
+    }
+    EXPECT_NEAR(array.parallel_total_area(4), 10000 * hexagon->area(), 1e-6);
+    std::vector<Point> centers = array.parallel_transform([](const Figure& f) { return f.center(); }, 4);
+    EXPECT_NEAR(centers.back().x, 1.0, 1e-9);
+}
+
+TEST(FigureArrayAggregatesTest, TotalAreaAndCounts) {
+    FigureArray array;
+    array.add(std::make_shared<Rhombus>(Point(0, 0), 4, 6));
+    array.add(std::make_shared<Pentagon>(Point(0, 0), 1));
+    array.add(std::make_shared<Hexagon>(Point(0, 0), 1));
+    array.add(std::make_shared<Rhombus>(Point(1, 1), 2, 2));
+
+    double expected = 12.0 + 2.0 + array.get(1)->area() + array.get(2)->area();
+    EXPECT_NEAR(array.total_area(), expected, 1e-9);
+    EXPECT_EQ(array.count(FigureType::Rhombus), 2);
+    EXPECT_EQ(array.count(FigureType::Pentagon), 1);
+    EXPECT_EQ(array.count(FigureType::Hexagon), 1);
+
+    array.remove(0);
+    EXPECT_NEAR(array.total_area(), expected - 12.0, 1e-9);
+    EXPECT_EQ(array.count(FigureType::Rhombus), 1);
+
+    while (array.size() > 0) array.remove(0);
+    EXPECT_EQ(array.total_area(), 0.0);
+    EXPECT_THROW(array.add(nullptr), std::invalid_argument);
+}
+
+TEST(FigureArrayAggregatesTest, BoundsFollowAddAndRemove) {
+    FigureArray array;
+    EXPECT_FALSE(array.bounds().has_value());
+
+    array.add(std::make_shared<Rhombus>(Point(0, 0), 4, 6));
+    array.add(std::make_shared<Rhombus>(Point(10, 0), 2, 2));
+    array.add(std::make_shared<Rhombus>(Point(5, 0), 1, 1));
+
+    BoundingBox box = *array.bounds();
+    EXPECT_NEAR(box.min.x, -2.0, 1e-9);
+    EXPECT_NEAR(box.max.x, 11.0, 1e-9);
+    EXPECT_NEAR(box.min.y, -3.0, 1e-9);
+    EXPECT_NEAR(box.max.y, 3.0, 1e-9);
+
+    array.remove(0);
+    box = *array.bounds();
+    EXPECT_NEAR(box.min.x, 4.5, 1e-9);
+    EXPECT_NEAR(box.max.x, 11.0, 1e-9);
+    EXPECT_NEAR(box.max.y, 1.0, 1e-9);
+}
+
+TEST(FigureArrayAggregatesTest, ChurnDoesNotRescanOnRemove) {
+    // Counts vertex reads, so a rescan of the whole array shows up.
+    class CountingSquare : public Figure {
+    private:
+        std::array<Point, 4> vertices;
+        size_t* reads;
+
+    public:
+        CountingSquare(double x, size_t* reads)
+            : vertices{Point(x, 0), Point(x + 1, 0), Point(x + 1, 1), Point(x, 1)}, reads(reads) {}
+        Point center() const override { return Point(vertices[0].x + 0.5, 0.5); }
+        double area() const override { return 1; }
+        void read(std::istream&) override {}
+        size_t vertex_count() const override { return 4; }
+        const Point& vertex(size_t i) const override { ++*reads; return vertices.at(i); }
+        void apply(const Affine& t) override { t.apply(vertices.data(), 4); }
+        std::shared_ptr<Figure> clone() const override { return std::make_shared<CountingSquare>(*this); }
+        std::shared_ptr<Figure> clone(const PoolAllocator<Figure>&) const override { return clone(); }
+        bool equals(const Figure&) const override { return false; }
+    };
+
+    // Sliding window: add at increasing x, remove the oldest, which always
+    // sits on the left edge of the box.
+    const size_t window = 1000;
+    const size_t steps = 5000;
+    size_t reads = 0;
+    FigureArray array;
+    std::deque<FigureHandle> live;
+    for (size_t i = 0; i < window; ++i) {
+        live.push_back(array.add(std::make_shared<CountingSquare>(double(i), &reads)));
+    }
+    reads = 0;
+    for (size_t i = window; i < window + steps; ++i) {
+        live.push_back(array.add(std::make_shared<CountingSquare>(double(i), &reads)));
+        array.remove(live.front());
+        live.pop_front();
+    }
+    EXPECT_LT(reads, 16 * steps);
+
+    BoundingBox box = *array.bounds();
+    EXPECT_EQ(box.min.x, double(steps));
+    EXPECT_EQ(box.max.x, double(window + steps));
+    EXPECT_NEAR(array.total_area(), double(window), 1e-9);
+}
+
+TEST(FigureArrayAggregatesTest, CompensatedSumDoesNotDrift) {
+    FigureArray plain;
+    FigureArray compensated(true);
+    auto huge = std::make_shared<Rhombus>(Point(0, 0), 2e8, 1e8);
+    auto tiny = std::make_shared<Rhombus>(Point(0, 0), 0.2, 0.1);
+    plain.add(huge);
+    compensated.add(huge);
+    for (int i = 0; i < 1000; ++i) {
+        plain.add(tiny);
+        compensated.add(tiny);
+    }
+    plain.remove(0);
+    compensated.remove(0);
+
+    EXPECT_NEAR(compensated.total_area(), 1000 * tiny->area(), 1e-9);
+    EXPECT_GT(std::abs(plain.total_area() - 1000 * tiny->area()), 1e-6);
+}
+
+TEST(FigureArrayAggregatesTest, RefreshAfterMutation) {
+    FigureArray array;
+    auto rhombus = std::make_shared<Rhombus>(Point(0, 0), 4, 6);
+    array.add(rhombus);
+    std::stringstream ss("0 1 1 0 0 -1 -1 0");
+    ss >> *rhombus;
+    array.refresh();
+    EXPECT_NEAR(array.total_area(), 2.0, 1e-9);
+    EXPECT_NEAR(array.bounds()->max.x, 1.0, 1e-9);
+}
+
+TEST(FigureArrayAggregatesTest, UpdateKeepsAggregatesInSync) {
+    FigureArray array;
+    array.enable_spatial_index(1.0);
+    array.enable_equality_index();
+    auto outer = std::make_shared<Rhombus>(Point(10, 0), 2, 2);
+    FigureHandle inner = array.add(std::make_shared<Rhombus>(Point(0, 0), 2, 2));
+    FigureHandle edge = array.add(outer);
+
+    EXPECT_TRUE(array.update(edge, [](Figure& f) { f.apply(Affine::translation(-5, 0)); }));
+    EXPECT_NEAR(outer->center().x, 10.0, 1e-12);
+    EXPECT_NEAR(array.get(edge)->center().x, 5.0, 1e-12);
+    EXPECT_NEAR(array.bounds()->max.x, 6.0, 1e-9);
+    EXPECT_EQ(array.query_region(BoundingBox{Point(9, -1), Point(11, 1)}).size(), 0u);
+    EXPECT_TRUE(array.find_equal(Rhombus(Point(5, 0), 2, 2)).has_value());
+
+    array.update(inner, [](Figure& f) { f.apply(Affine::scaling(2, 2)); });
+    EXPECT_NEAR(array.total_area(), 2.0 + 8.0, 1e-9);
+    EXPECT_NEAR(array.bounds()->min.x, -2.0, 1e-9);
+
+    array.remove(inner);
+    EXPECT_FALSE(array.update(inner, [](Figure&) {}));
+    EXPECT_NEAR(array.bounds()->min.x, 4.0, 1e-9);
+}
+
+TEST(FigureArrayParallelTest, TotalAreaIsDeterministic) {
+    FigureArray array;
+    for (int i = 0; i < 20000; ++i) {
+        Point c(i % 100, i / 100);
+        if (i % 3 == 0) array.add(std::make_shared<Rhombus>(c, 1 + i % 7, 0.1 + i % 5));
+        else if (i % 3 == 1) array.add(std::make_shared<Pentagon>(c, 0.3 + i % 11));
+        else array.add(std::make_shared<Hexagon>(c, 0.7 + i % 13));
+    }
+
+    double single = array.parallel_total_area(1);
+    EXPECT_NEAR(single, array.total_area(), 1e-6 * single);
+    for (size_t threads : {2, 3, 4, 8}) {
+        EXPECT_EQ(array.parallel_total_area(threads), single);
+    }
+}
+
+TEST(FigureArrayParallelTest, BulkOperations) {
+    FigureArray array;
+    for (int i = 0; i < 10000; ++i) {
+        if (i % 4 == 0) array.add(std::make_shared<Hexagon>(Point(i, 0), 1));
+        else array.add(std::make_shared<Rhombus>(Point(i, 0), 2, 2));
+    }
+
+    size_t hexagons = array.parallel_count_if([](const Figure& f) {
+        return f.type() == FigureType::Hexagon;
+    }, 4);
+    EXPECT_EQ(hexagons, 2500);
+
+    std::vector<double> xs = array.parallel_transform([](const Figure& f) { return f.center().x; }, 3);
+    ASSERT_EQ(xs.size(), 10000);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        EXPECT_NEAR(xs[i], double(i), 1e-9);
+    }
+
+    std::atomic<size_t> visited(0);
+    array.parallel_for_each([&](Figure&) { ++visited; }, 4);
+    EXPECT_EQ(visited.load(), 10000);
+
+    EXPECT_THROW(array.parallel_for_each([](Figure&) { throw std::runtime_error("stop"); }, 2),
+                 std::runtime_error);
+}
+
+TEST(FigureArrayParallelTest, ForEachRefreshesAggregates) {
+    FigureArray array;
+    for (int i = 0; i < 10000; ++i) {
+        array.add(std::make_shared<Rhombus>(Point(i, 0), 2, 2));
+    }
+    array.parallel_for_each([](Figure& f) { f.apply(Affine::scaling(2, 2)); }, 4);
+    EXPECT_NEAR(array.total_area(), 10000 * 8.0, 1e-6);
+    EXPECT_NEAR(array.bounds()->max.x, 2 * 9999 + 2.0, 1e-9);
+}
+
+TEST(FigureArrayParallelTest, NestedCallsShareThePool) {
+    FigureArray array;
+    for (int i = 0; i < 20000; ++i) {
+        array.add(std::make_shared<Hexagon>(Point(i, 0), 1));
+    }
+    for (int round = 0; round < 20; ++round) {
+        std::vector<double> totals = array.parallel_transform([&](const Figure& f) {
+            return &f == &array.at(0) ? array.parallel_total_area(4) : 0.0;
+        }, 4);
+        EXPECT_NEAR(totals[0], array.total_area(), 1e-6 * array.total_area());
+    }
+}
+
+TEST(FigureArrayHandleTest, HandlesSurviveRemovals) {
+    FigureArray array;
+    FigureHandle a = array.add(std::make_shared<Rhombus>(Point(0, 0), 4, 6));
+    FigureHandle b = array.add(std::make_shared<Pentagon>(Point(1, 0), 1));
+    FigureHandle c = array.add(std::make_shared<Hexagon>(Point(2, 0), 1));
+
+    EXPECT_TRUE(array.remove(a));
+    EXPECT_FALSE(array.remove(a));
+    EXPECT_FALSE(array.contains(a));
+    EXPECT_EQ(array.get(a), nullptr);
+    EXPECT_EQ(array.size(), 2);
+
+    ASSERT_NE(array.get(b), nullptr);
+    ASSERT_NE(array.get(c), nullptr);
+    EXPECT_EQ(array.get(b)->type(), FigureType::Pentagon);
+    EXPECT_EQ(array.get(c)->type(), FigureType::Hexagon);
+    EXPECT_EQ(array.get(*array.index_of(c)), array.get(c));
+    EXPECT_NEAR(array.total_area(), array.get(b)->area() + array.get(c)->area(), 1e-9);
+}
+
+TEST(FigureArrayHandleTest, ReusedSlotsRejectStaleHandles) {
+    FigureArray array;
+    FigureHandle first = array.add(std::make_shared<Rhombus>(Point(0, 0), 1, 1));
+    array.remove(first);
+    FigureHandle second = array.add(std::make_shared<Rhombus>(Point(5, 5), 1, 1));
+
+    EXPECT_EQ(first.slot, second.slot);
+    EXPECT_NE(first, second);
+    EXPECT_FALSE(array.contains(first));
+    EXPECT_TRUE(array.contains(second));
+}
+
+TEST(FigureArrayHandleTest, IndexRemovalKeepsHandlesValid) {
+    FigureArray array;
+    std::vector<FigureHandle> handles;
+    for (int i = 0; i < 5; ++i) {
+        handles.push_back(array.add(std::make_shared<Hexagon>(Point(i, 0), 1)));
+    }
+
+    array.remove(size_t(1));
+    EXPECT_FALSE(array.contains(handles[1]));
+    for (int i : {0, 2, 3, 4}) {
+        ASSERT_TRUE(array.contains(handles[i]));
+        EXPECT_NEAR(array.get(handles[i])->center().x, double(i), 1e-9);
+    }
+    EXPECT_EQ(array.handle_at(1), handles[2]);
+    EXPECT_NEAR(array.get(1)->center().x, 2.0, 1e-9);
+}
+
+namespace {
+
+std::vector<uint32_t> sorted_slots(const std::vector<FigureHandle>& handles) {
+    std::vector<uint32_t> slots;
+    for (const auto& h : handles) slots.push_back(h.slot);
+    std::sort(slots.begin(), slots.end());
+    return slots;
+}
+
+FigureArray random_figures(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> pos(-100, 100);
+    std::uniform_real_distribution<double> size(0.1, 4);
+    FigureArray array;
+    for (size_t i = 0; i < n; ++i) {
+        Point c(pos(rng), pos(rng));
+        switch (i % 3) {
+            case 0: array.add(std::make_shared<Rhombus>(c, size(rng), size(rng))); break;
+            case 1: array.add(std::make_shared<Pentagon>(c, size(rng))); break;
+            default: array.add(std::make_shared<Hexagon>(c, size(rng))); break;
+        }
+    }
+    return array;
+}
+
+}
+
+TEST(SpatialIndexTest, RangeQueryMatchesScan) {
+    FigureArray array = random_figures(2000, 1);
+    std::vector<BoundingBox> regions = {
+        {Point(-10, -10), Point(10, 10)},
+        {Point(50, -100), Point(51, 100)},
+        {Point(-1000, -1000), Point(1000, 1000)},
+        {Point(200, 200), Point(300, 300)},
+    };
+
+    std::vector<std::vector<uint32_t>> expected;
+    for (const auto& r : regions) expected.push_back(sorted_slots(array.query_region(r)));
+
+    array.enable_spatial_index(5.0);
+    for (size_t i = 0; i < regions.size(); ++i) {
+        EXPECT_EQ(sorted_slots(array.query_region(regions[i])), expected[i]);
+    }
+    EXPECT_EQ(expected[2].size(), 2000);
+    EXPECT_TRUE(expected[3].empty());
+}
+
+TEST(SpatialIndexTest, NearestMatchesScan) {
+    FigureArray array = random_figures(1500, 2);
+    std::vector<Point> probes = {Point(0, 0), Point(99, -99), Point(500, 500)};
+
+    std::vector<std::vector<FigureHandle>> expected;
+    for (const auto& p : probes) expected.push_back(array.nearest(p, 7));
+
+    array.enable_spatial_index(4.0);
+    for (size_t i = 0; i < probes.size(); ++i) {
+        std::vector<FigureHandle> got = array.nearest(probes[i], 7);
+        ASSERT_EQ(got.size(), 7);
+        for (size_t j = 0; j < got.size(); ++j) {
+            EXPECT_EQ(got[j], expected[i][j]);
+        }
+    }
+    EXPECT_EQ(array.nearest(Point(0, 0), 5000).size(), 1500);
+}
+
+TEST(SpatialIndexTest, StaysInSyncWithAddAndRemove) {
+    FigureArray array;
+    array.enable_spatial_index(1.0);
+    FigureHandle a = array.add(std::make_shared<Rhombus>(Point(0, 0), 1, 1));
+    FigureHandle b = array.add(std::make_shared<Hexagon>(Point(10, 10), 0.5));
+    FigureHandle c = array.add(std::make_shared<Pentagon>(Point(0.5, 0.5), 0.5));
+
+    BoundingBox near_origin{Point(-1, -1), Point(1, 1)};
+    EXPECT_EQ(array.query_region(near_origin).size(), 2);
+
+    array.remove(a);
+    std::vector<FigureHandle> hits = array.query_region(near_origin);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0], c);
+
+    array.remove(size_t(*array.index_of(c)));
+    EXPECT_TRUE(array.query_region(near_origin).empty());
+    ASSERT_EQ(array.nearest(Point(0, 0), 3).size(), 1);
+    EXPECT_EQ(array.nearest(Point(0, 0), 3)[0], b);
+}
+
+TEST(SpatialIndexTest, SparseAndOversizedFigures) {
+    SpatialGrid grid(1.0);
+    Rhombus near(Point(0, 0), 1, 1);
+    Rhombus far(Point(5e8, -5e8), 1, 1);
+    Hexagon huge(Point(3, 0), 1e6);
+    grid.insert(FigureHandle{0, 0}, near.bounding_box(), near.center());
+    grid.insert(FigureHandle{1, 0}, far.bounding_box(), far.center());
+    grid.insert(FigureHandle{2, 0}, huge.bounding_box(), huge.center());
+    grid.insert(FigureHandle{3, 0}, far.bounding_box(), Point(-5e8, 5e8));
+
+    std::vector<FigureHandle> two = grid.nearest(Point(4e8, -4e8), 2);
+    ASSERT_EQ(two.size(), 2);
+    EXPECT_EQ(two[0], (FigureHandle{1, 0}));
+    EXPECT_EQ(two[1], (FigureHandle{2, 0}));
+
+    std::vector<FigureHandle> hits = grid.query(BoundingBox{Point(100, 100), Point(101, 101)});
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(hits[0], (FigureHandle{2, 0}));
+
+    grid.erase(FigureHandle{2, 0});
+    EXPECT_TRUE(grid.query(BoundingBox{Point(100, 100), Point(101, 101)}).empty());
+    EXPECT_EQ(grid.nearest(Point(4e8, -4e8), 2)[1], (FigureHandle{0, 0}));
+}
+
+TEST(CollisionTest, SeparatingAxisNarrowPhase) {
+    Rhombus a(Point(0, 0), 2, 2);
+    Rhombus touching(Point(2, 0), 2, 2);
+    Rhombus diagonal_gap(Point(1.1, 1.1), 2, 2);
+    Hexagon around(Point(0, 0), 5);
+    Pentagon far(Point(10, 0), 1);
+
+    EXPECT_TRUE(figures_intersect(a, touching));
+    EXPECT_FALSE(figures_intersect(a, diagonal_gap));
+    EXPECT_TRUE(figures_intersect(a, around));
+    EXPECT_TRUE(figures_intersect(around, a));
+    EXPECT_FALSE(figures_intersect(around, far));
+}
+
+TEST(CollisionTest, FindOverlapsMatchesBruteForce) {
+    FigureArray array = random_figures(600, 3);
+
+    std::vector<std::pair<size_t, size_t>> expected;
+    for (size_t i = 0; i < array.size(); ++i) {
+        for (size_t j = i + 1; j < array.size(); ++j) {
+            if (figures_intersect(array.at(i), array.at(j))) {
+                expected.emplace_back(i, j);
+            }
+        }
+    }
+
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(find_overlaps(array), expected);
+    EXPECT_EQ(find_overlaps(array, 4), expected);
+    EXPECT_TRUE(find_overlaps(FigureArray()).empty());
+}
+
+TEST(FigureLoaderTest, ParsesAllTypes) {
+    std::string text =
+        "# two figures\n"
+        "rhombus 0 1 1 0 0 -1 -1 0\n"
+        "\n"
+        "hexagon 1 0 0.5 0.866025 -0.5 0.866025 -1 0 -0.5 -0.866025 0.5 -0.866025\n";
+    FigureArray array = parse_figures(text);
+    ASSERT_EQ(array.size(), 2);
+    EXPECT_EQ(array.at(0).type(), FigureType::Rhombus);
+    EXPECT_EQ(array.at(1).type(), FigureType::Hexagon);
+    EXPECT_NEAR(array.at(0).area(), 2.0, 1e-9);
+    EXPECT_NEAR(array.at(1).center().x, 0.0, 1e-6);
+}
+
+TEST(FigureLoaderTest, ThreadedParseKeepsOrder) {
+    std::string text;
+    for (int i = 0; i < 500; ++i) {
+        double x = i;
+        text += "rhombus " + std::to_string(x) + " 1 " + std::to_string(x + 1) + " 0 " +
+                std::to_string(x) + " -1 " + std::to_string(x - 1) + " 0\n";
+        if (i % 3 == 0) {
+            text += "pentagon 1 0 0.309017 0.951057 -0.809017 0.587785 -0.809017 -0.587785 0.309017 -0.951057\n";
+        }
+    }
+    FigureArray serial = parse_figures(text, 1);
+    FigureArray threaded = parse_figures(text, 4);
+    ASSERT_EQ(serial.size(), threaded.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial.at(i).type(), threaded.at(i).type());
+        EXPECT_DOUBLE_EQ(serial.at(i).center().x, threaded.at(i).center().x);
+    }
+    EXPECT_EQ(serial.count(FigureType::Pentagon), 167);
+}
+
+TEST(FigureLoaderTest, ReportsLineOfError) {
+    std::string text;
+    for (int i = 0; i < 100; ++i) {
+        text += "rhombus 0 1 1 0 0 -1 -1 0\n";
+    }
+    text += "rhombus 0 1 1 0 0 -1 -1 x\n";
+    for (size_t threads : {1, 3}) {
+        try {
+            parse_figures(text, threads);
+            FAIL() << "expected FigureParseError";
+        } catch (const FigureParseError& e) {
+            EXPECT_EQ(e.line(), 101);
+        }
+    }
+    EXPECT_THROW(parse_figures("square 0 0 1 1\n"), FigureParseError);
+    EXPECT_THROW(parse_figures("rhombus 0 1 1 0 0 -1\n"), FigureParseError);
+    EXPECT_THROW(parse_figures("rhombus 0 1 1 0 0 -1 -1 0 5\n"), FigureParseError);
+}
+
+TEST(FigureLoaderTest, LoadsFromFile) {
+    std::string path = ::testing::TempDir() + "figures_loader_test.txt";
+    {
+        std::ofstream out(path);
+        out << "rhombus 0 1 1 0 0 -1 -1 0\n";
+        out << "rhombus 0 2 2 0 0 -2 -2 0";
+    }
+    FigureArray array = load_figures(path, 2);
+    std::remove(path.c_str());
+    ASSERT_EQ(array.size(), 2);
+    EXPECT_NEAR(array.total_area(), 10.0, 1e-9);
+    EXPECT_THROW(load_figures(path), std::runtime_error);
+}
+
+TEST(FigureSnapshotTest, RoundTrip) {
+    FigureArray array = random_figures(300, 7);
+    std::string path = ::testing::TempDir() + "figures_snapshot_test.bin";
+    write_snapshot(array, path);
+
+    FigureSnapshot snapshot(path);
+    ASSERT_EQ(snapshot.size(), array.size());
+    for (size_t i = 0; i < array.size(); ++i) {
+        const Figure& figure = array.at(i);
+        ASSERT_EQ(snapshot.type(i), figure.type());
+        ASSERT_EQ(snapshot.vertex_count(i), figure.vertex_count());
+        for (size_t v = 0; v < figure.vertex_count(); ++v) {
+            EXPECT_EQ(snapshot.vertex(i, v).x, figure.vertex(v).x);
+            EXPECT_EQ(snapshot.vertex(i, v).y, figure.vertex(v).y);
+        }
+    }
+    FigureArray restored = snapshot.to_array();
+    EXPECT_DOUBLE_EQ(restored.total_area(), array.total_area());
+    EXPECT_EQ(restored.count(FigureType::Hexagon), array.count(FigureType::Hexagon));
+    EXPECT_THROW(snapshot.type(array.size()), std::out_of_range);
+    std::remove(path.c_str());
+}
+
+TEST(FigureSnapshotTest, RejectsInvalidFiles) {
+    std::string path = ::testing::TempDir() + "figures_snapshot_bad.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "rhombus 0 1 1 0 0 -1 -1 0\n";
+    }
+    EXPECT_THROW(FigureSnapshot snapshot(path), std::runtime_error);
+
+    std::ostringstream os;
+    write_snapshot(random_figures(10, 8), os);
+    std::string bytes = os.str();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(bytes.data(), bytes.size() - 8);
+    }
+    EXPECT_THROW(FigureSnapshot snapshot(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(FigureSnapshotTest, EmptyArray) {
+    std::string path = ::testing::TempDir() + "figures_snapshot_empty.bin";
+    write_snapshot(FigureArray(), path);
+    FigureSnapshot snapshot(path);
+    EXPECT_EQ(snapshot.size(), 0);
+    EXPECT_EQ(snapshot.to_array().size(), 0);
+    std::remove(path.c_str());
+}
+
+TEST(FigurePrinterTest, MatchesStreamOutput) {
+    FigureArray array = random_figures(200, 9);
+    std::ostringstream expected;
+    for (size_t i = 0; i < array.size(); ++i) {
+        const Figure& figure = array.at(i);
+        expected << "Figure " << i << ": " << figure
+                 << ", Area: " << figure.area()
+                 << ", Center: (" << figure.center().x
+                 << ", " << figure.center().y << ")" << "\n";
+    }
+    std::ostringstream actual;
+    array.print_all(actual);
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+TEST(FigurePrinterTest, HonorsStreamFormatting) {
+    FigureArray array = random_figures(50, 11);
+    std::vector<std::function<void(std::ostream&)>> setups = {
+        [](std::ostream& os) { os << std::fixed << std::setprecision(2); },
+        [](std::ostream& os) { os << std::scientific << std::setprecision(10); },
+        [](std::ostream& os) { os << std::setprecision(17); },
+        [](std::ostream& os) { os << std::hexfloat; },
+        [](std::ostream& os) { os << std::showpos << std::hex; },
+    };
+    for (const auto& setup : setups) {
+        std::ostringstream expected;
+        setup(expected);
+        for (size_t i = 0; i < array.size(); ++i) {
+            const Figure& figure = array.at(i);
+            expected << "Figure " << i << ": " << figure
+                     << ", Area: " << figure.area()
+                     << ", Center: (" << figure.center().x
+                     << ", " << figure.center().y << ")" << "\n";
+        }
+        std::ostringstream actual;
+        setup(actual);
+        array.print_all(actual);
+        EXPECT_EQ(actual.str(), expected.str());
+    }
+}
+
+TEST(FigurePrinterTest, SinkErrorsPropagate) {
+    FigureArray array = random_figures(10, 12);
+    std::ostringstream broken;
+    broken.setstate(std::ios_base::badbit);
+    EXPECT_THROW(array.print_all(broken), std::runtime_error);
+
+    std::FILE* file = std::fopen("/dev/full", "w");
+    if (file) {
+        FileSink sink(file);
+        EXPECT_THROW(array.print_all(sink, 1), std::runtime_error);
+        std::fclose(file);
+    }
+}
+
+TEST(FigurePrinterTest, ParallelOutputKeepsOrder) {
+    class CountingSink : public OutputSink {
+    public:
+        std::string text;
+        size_t writes = 0;
+        void write(const char* data, size_t size) override {
+            text.append(data, size);
+            ++writes;
+        }
+    };
+
+    FigureArray array = random_figures(20000, 10);
+    std::ostringstream serial;
+    array.print_all(serial);
+
+    CountingSink sink;
+    array.print_all(sink, 3);
+    EXPECT_EQ(sink.text, serial.str());
+    EXPECT_LE(sink.writes, block_count(array.size()));
+}
+
+TEST(PolygonTest, ShoelaceAreaForIrregularInput) {
+    Polygon<5> house(std::vector<Point>{
+        Point(0, 0), Point(4, 0), Point(4, 3), Point(2, 5), Point(0, 3)});
+    EXPECT_NEAR(house.area(), 16.0, 1e-12);
+    EXPECT_EQ(house.type(), FigureType::Pentagon);
+
+    Polygon<6> reversed(std::vector<Point>{
+        Point(0, 0), Point(0, 2), Point(1, 3), Point(2, 2), Point(2, 0), Point(1, -1)});
+    EXPECT_NEAR(reversed.area(), 6.0, 1e-12);
+    EXPECT_THROW(Polygon<6>(std::vector<Point>(5)), std::invalid_argument);
+}
+
+TEST(PolygonTest, RegularAreaMatchesShoelace) {
+    Hexagon hexagon(Point(1, 2), 3);
+    Polygon<6> same(std::vector<Point>(&hexagon.vertex(0), &hexagon.vertex(0) + 6));
+    EXPECT_NEAR(hexagon.area(), same.area(), 1e-12);
+    EXPECT_NEAR(hexagon.area(), 1.5 * std::sqrt(3.0) * 9, 1e-12);
+
+    auto cloned = hexagon.clone();
+    EXPECT_NE(std::dynamic_pointer_cast<Hexagon>(cloned), nullptr);
+    EXPECT_TRUE(*cloned == same);
+}
+
+TEST(PolygonTest, ColumnsUseShoelace) {
+    FigureColumns columns;
+    columns.add(Polygon<5>(std::vector<Point>{
+        Point(0, 0), Point(4, 0), Point(4, 3), Point(2, 5), Point(0, 3)}));
+    columns.add(Pentagon(Point(0, 0), 2));
+    EXPECT_NEAR(columns.pentagon_area(), 16.0 + Pentagon(Point(0, 0), 2).area(), 1e-9);
+}
+
+TEST(FigureEqualityTest, TagBasedEquality) {
+    Rhombus rhombus(Point(0, 0), 2, 2);
+    Hexagon hexagon(Point(0, 0), 1);
+    Polygon<6> irregular(std::vector<Point>(&hexagon.vertex(0), &hexagon.vertex(0) + 6));
+
+    EXPECT_EQ(rhombus.type(), FigureType::Rhombus);
+    EXPECT_FALSE(rhombus == hexagon);
+    EXPECT_FALSE(hexagon == rhombus);
+    EXPECT_TRUE(hexagon == irregular);
+    EXPECT_TRUE(irregular == hexagon);
+    EXPECT_EQ(hexagon.hash(), irregular.hash());
+    EXPECT_NE(hexagon.hash(), Hexagon(Point(0, 0), 2).hash());
+}
+
+TEST(FigureEqualityTest, HashProbesStraddleRoundingBoundaries) {
+    // 0.5 quanta is a rounding boundary; the two rhombi are 4e-10 apart,
+    // so they are equal but round to different buckets.
+    double edge = 0.5 * figure_hash_quantum;
+    Rhombus below(Point(edge - 2e-10, 0), 2, 2);
+    Rhombus above(Point(edge + 2e-10, 0), 2, 2);
+    ASSERT_TRUE(below == above);
+    EXPECT_NE(below.hash(), above.hash());
+    std::vector<size_t> probes = below.equal_hashes();
+    EXPECT_NE(std::find(probes.begin(), probes.end(), above.hash()), probes.end());
+    EXPECT_EQ(Rhombus(Point(0, 0), 2, 2).equal_hashes(),
+              std::vector<size_t>{Rhombus(Point(0, 0), 2, 2).hash()});
+
+    FigureArray array;
+    array.enable_equality_index();
+    FigureHandle stored = array.add(std::make_shared<Rhombus>(above));
+    EXPECT_EQ(array.find_equal(below), stored);
+    array.add(std::make_shared<Rhombus>(below));
+    EXPECT_EQ(array.deduplicate(), 1);
+}
+
+TEST(FigureEqualityTest, OtherFiguresUseTheVirtualInterface) {
+    class Triangle : public Figure {
+    private:
+        std::array<Point, 3> vertices;
+
+    public:
+        explicit Triangle(const std::array<Point, 3>& vertices) : vertices(vertices) {}
+        Point center() const override { return Point(1, 1); }
+        double area() const override { return 2; }
+        void print(std::ostream& os) const override { os << "Triangle " << vertices[2].y; }
+        void read(std::istream&) override {}
+        size_t vertex_count() const override { return 3; }
+        const Point& vertex(size_t i) const override { return vertices.at(i); }
+        void apply(const Affine& t) override { t.apply(vertices.data(), 3); }
+        std::shared_ptr<Figure> clone() const override { return std::make_shared<Triangle>(*this); }
+        std::shared_ptr<Figure> clone(const PoolAllocator<Figure>&) const override { return clone(); }
+        bool equals(const Figure& other) const override {
+            return other.type() == FigureType::Other && other.vertex(2) == vertices[2];
+        }
+    };
+
+    FigureArray array;
+    array.add(std::make_shared<Triangle>(std::array<Point, 3>{Point(0, 0), Point(3, 0), Point(0, 1.5)}));
+    EXPECT_EQ(array.at(0).type(), FigureType::Other);
+    EXPECT_EQ(array.count(FigureType::Other), 1);
+    EXPECT_FALSE(array.at(0) == Rhombus(Point(0, 0), 2, 2));
+
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(1);
+    array.print_all(os);
+    EXPECT_EQ(os.str(), "Figure 0: Triangle 1.5, Area: 2.0, Center: (1.0, 1.0)\n");
+
+    std::ostringstream snapshot;
+    EXPECT_THROW(write_snapshot(array, snapshot), std::invalid_argument);
+    FigureColumns columns;
+    EXPECT_THROW(columns.add(array.at(0)), std::invalid_argument);
+}
+
+TEST(FigureEqualityTest, FindEqualWithAndWithoutIndex) {
+    FigureArray array = random_figures(500, 11);
+    std::shared_ptr<Figure> probe = array.at(123).clone();
+
+    std::optional<FigureHandle> scanned = array.find_equal(*probe);
+    array.enable_equality_index();
+    std::optional<FigureHandle> indexed = array.find_equal(*probe);
+    ASSERT_TRUE(scanned && indexed);
+    EXPECT_EQ(*scanned, *indexed);
+    EXPECT_EQ(array.index_of(*indexed), 123);
+
+    array.remove(*indexed);
+    EXPECT_FALSE(array.find_equal(*probe));
+    FigureHandle added = array.add(probe);
+    EXPECT_EQ(array.find_equal(*probe), added);
+    EXPECT_FALSE(array.find_equal(Rhombus(Point(1e6, 1e6), 1, 1)));
+}
+
+TEST(FigureEqualityTest, Deduplicate) {
+    FigureArray array;
+    array.enable_equality_index();
+    std::vector<std::shared_ptr<Figure>> originals;
+    for (int i = 0; i < 50; ++i) {
+        originals.push_back(std::make_shared<Pentagon>(Point(i, -i), 1 + i % 4));
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (const auto& figure : originals) {
+            array.add(figure->clone());
+        }
+    }
+    double expected_area = 0;
+    for (const auto& figure : originals) {
+        expected_area += figure->area();
+    }
+
+    EXPECT_EQ(array.deduplicate(), 100);
+    ASSERT_EQ(array.size(), 50);
+    for (size_t i = 0; i < originals.size(); ++i) {
+        EXPECT_TRUE(array.at(i) == *originals[i]);
+        std::optional<FigureHandle> found = array.find_equal(*originals[i]);
+        ASSERT_TRUE(found);
+        EXPECT_EQ(array.index_of(*found), i);
+    }
+    EXPECT_NEAR(array.total_area(), expected_area, 1e-9);
+    EXPECT_EQ(array.count(FigureType::Pentagon), 50);
+    EXPECT_EQ(array.deduplicate(), 0);
+}
+
+TEST(AffineTest, Composition) {
+    Affine t = Affine::rotation(M_PI / 2, Point(1, 1));
+    Point p = t.apply(Point(2, 1));
+    EXPECT_NEAR(p.x, 1, 1e-12);
+    EXPECT_NEAR(p.y, 2, 1e-12);
+    EXPECT_TRUE(t.is_similarity());
+    EXPECT_TRUE((Affine::scaling(-2, 2) * Affine::translation(3, 4)).is_similarity());
+    EXPECT_FALSE(Affine::scaling(2, 3).is_similarity());
+    EXPECT_DOUBLE_EQ((Affine::scaling(2, 3) * Affine::rotation(0.3)).determinant(), 6);
+}
+
+TEST(FigureTransformTest, TranslateAndRotateKeepAreas) {
+    FigureArray array = random_figures(3000, 12);
+    array.enable_spatial_index(2.0);
+    double area = array.total_area();
+    std::vector<Point> centers = array.parallel_transform([](const Figure& f) { return f.center(); });
+
+    array.transform(Affine::translation(5, -3), 2);
+    EXPECT_DOUBLE_EQ(array.total_area(), area);
+    for (size_t i = 0; i < array.size(); ++i) {
+        EXPECT_NEAR(array.at(i).center().x, centers[i].x + 5, 1e-9);
+        EXPECT_NEAR(array.at(i).center().y, centers[i].y - 3, 1e-9);
+    }
+
+    Affine rotate = Affine::rotation(0.7);
+    array.transform(rotate);
+    EXPECT_NEAR(array.total_area(), area, 1e-9 * area);
+    for (size_t i = 0; i < array.size(); i += 97) {
+        Point expected = rotate.apply(Point(centers[i].x + 5, centers[i].y - 3));
+        EXPECT_NEAR(array.at(i).center().x, expected.x, 1e-9);
+        EXPECT_NEAR(array.at(i).center().y, expected.y, 1e-9);
+    }
+
+    double recomputed = array.parallel_total_area();
+    EXPECT_NEAR(array.total_area(), recomputed, 1e-9 * area);
+
+    BoundingBox box = *array.bounds();
+    FigureArray fresh = random_figures(3000, 12);
+    fresh.transform(rotate * Affine::translation(5, -3));
+    BoundingBox expected = *fresh.bounds();
+    EXPECT_NEAR(box.min.x, expected.min.x, 1e-9);
+    EXPECT_NEAR(box.max.y, expected.max.y, 1e-9);
+
+    EXPECT_EQ(sorted_slots(array.query_region(box)).size(), array.size());
+}
+
+TEST(FigureTransformTest, ScalingUpdatesAreasAndBounds) {
+    FigureArray array;
+    array.add(std::make_shared<Rhombus>(Point(1, 1), 2, 4));
+    array.add(std::make_shared<Hexagon>(Point(-1, 0), 1));
+    double rhombus = array.at(0).area();
+    double hexagon = array.at(1).area();
+
+    array.transform(Affine::scaling(3));
+    EXPECT_NEAR(array.at(0).area(), 9 * rhombus, 1e-9);
+    EXPECT_NEAR(array.total_area(), 9 * (rhombus + hexagon), 1e-9);
+    BoundingBox box = *array.bounds();
+    EXPECT_NEAR(box.min.x, -6, 1e-9);
+    EXPECT_NEAR(box.max.y, 9, 1e-9);
+
+    // A shear turns the rhombus into a parallelogram of the same area.
+    Affine shear{1, 1, 0, 0, 1, 0};
+    array.transform(shear);
+    EXPECT_NEAR(array.at(0).area(), 9 * rhombus, 1e-9);
+    EXPECT_NEAR(array.at(1).area(), 9 * hexagon, 1e-9);
+    EXPECT_NEAR(array.total_area(), 9 * (rhombus + hexagon), 1e-9);
+}
+
+TEST(FigureTransformTest, RotatedRhombusUnderNonSimilarities) {
+    auto shoelace = [](const Figure& f) {
+        double twice = 0;
+        for (size_t i = 0; i < f.vertex_count(); ++i) {
+            const Point& p = f.vertex(i);
+            const Point& q = f.vertex((i + 1) % f.vertex_count());
+            twice += p.x * q.y - q.x * p.y;
+        }
+        return std::abs(twice) / 2;
+    };
+    Rhombus rhombus(Point(1, 2), 2, 4);
+    rhombus.apply(Affine::rotation(M_PI / 4));
+
+    Rhombus sheared = rhombus;
+    sheared.apply(Affine{1, 1, 0, 0, 1, 0});
+    EXPECT_NEAR(sheared.area(), 4.0, 1e-12);
+    EXPECT_NEAR(sheared.area(), shoelace(sheared), 1e-12);
+
+    Rhombus stretched = rhombus;
+    stretched.apply(Affine::scaling(2, 3));
+    EXPECT_NEAR(stretched.area(), 24.0, 1e-12);
+    EXPECT_NEAR(stretched.area(), shoelace(stretched), 1e-12);
+    EXPECT_NEAR(stretched.center().x, Rhombus(stretched).center().x, 1e-12);
+
+    FigureColumns columns;
+    columns.add(sheared);
+    columns.add(stretched);
+    EXPECT_NEAR(columns.rhombus_area(), 28.0, 1e-12);
+}
+
+TEST(FigureTransformTest, SharedFiguresAreCopiedFirst) {
+    auto shared = std::make_shared<Rhombus>(Point(0, 0), 2, 2);
+    FigureArray array;
+    array.add(shared);
+    array.add(shared);
+    FigureArray copy = array;
+
+    array.transform(Affine::translation(1, 0), 2);
+    EXPECT_NEAR(array.at(0).center().x, 1.0, 1e-12);
+    EXPECT_NEAR(array.at(1).center().x, 1.0, 1e-12);
+    EXPECT_NE(&array.at(0), &array.at(1));
+    EXPECT_NEAR(shared->center().x, 0.0, 1e-12);
+    EXPECT_NEAR(copy.at(0).center().x, 0.0, 1e-12);
+    EXPECT_NEAR(copy.bounds()->max.x, 1.0, 1e-12);
+}
+
+TEST(FigureSelectionTest, TopKByArea) {
+    FigureArray array = random_figures(10000, 13);
+    std::vector<size_t> expected(array.size());
+    for (size_t i = 0; i < expected.size(); ++i) expected[i] = i;
+    std::stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) {
+        return array.at(a).area() > array.at(b).area();
+    });
+
+    for (size_t k : {0, 1, 25, 5000}) {
+        std::vector<size_t> serial = array.top_k_by_area(k);
+        std::vector<size_t> parallel = array.top_k_by_area(k, 3);
+        ASSERT_EQ(serial.size(), k);
+        EXPECT_EQ(serial, parallel);
+        EXPECT_TRUE(std::equal(serial.begin(), serial.end(), expected.begin()));
+    }
+    EXPECT_EQ(array.top_k_by_area(20000).size(), array.size());
+    EXPECT_TRUE(FigureArray().top_k_by_area(3).empty());
+}
+
+TEST(FigureSelectionTest, NearestScanMatchesIndex) {
+    FigureArray array = random_figures(6000, 14);
+    Point p(3, -2);
+    std::vector<FigureHandle> handles = array.nearest(p, 40, 2);
+    ASSERT_EQ(handles.size(), 40);
+    EXPECT_EQ(array.nearest(p, 40, 1), handles);
+    std::vector<size_t> result;
+    for (FigureHandle h : handles) result.push_back(*array.index_of(h));
+
+    array.enable_spatial_index(2.0);
+    EXPECT_EQ(array.nearest(p, 40), handles);
+    auto distance = [&](size_t i) {
+        Point c = array.at(i).center();
+        return std::hypot(c.x - p.x, c.y - p.y);
+    };
+    for (size_t i = 0; i < array.size(); ++i) {
+        if (std::find(result.begin(), result.end(), i) == result.end()) {
+            EXPECT_GE(distance(i), distance(result.back()));
+        }
+    }
+}
+
+TEST(FigurePoolTest, EmplaceAndClone) {
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t allocations = 0;
+        size_t live = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            ++allocations;
+            ++live;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            --live;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    auto counting = std::make_shared<CountingResource>();
+    PoolAllocator<Figure> alloc(counting);
+    std::shared_ptr<Figure> copy = Hexagon(Point(1, 1), 2).clone(alloc);
+    EXPECT_EQ(counting->allocations, 1);
+    EXPECT_TRUE(*copy == Hexagon(Point(1, 1), 2));
+    EXPECT_NE(std::dynamic_pointer_cast<Hexagon>(copy), nullptr);
+    copy.reset();
+    EXPECT_EQ(counting->live, 0);
+
+    FigureArray array;
+    FigureHandle a = array.emplace<Rhombus>(Point(0, 0), 2, 4);
+    FigureHandle b = array.emplace<Pentagon>(Point(1, 1), 1);
+    FigureHandle c = array.add_clone(*array.get(b));
+    EXPECT_EQ(array.size(), 3);
+    EXPECT_EQ(array.get(a)->type(), FigureType::Rhombus);
+    EXPECT_TRUE(*array.get(b) == *array.get(c));
+    EXPECT_NE(array.get(b), array.get(c));
+    EXPECT_NEAR(array.total_area(), 4 + 2 * Pentagon(Point(1, 1), 1).area(), 1e-9);
+    EXPECT_EQ(array.allocator(), PoolAllocator<Rhombus>(array.allocator()));
+}
+
+TEST(FigurePoolTest, CopiesShareThePool) {
+    std::shared_ptr<const Figure> kept;
+    FigureArray copy;
+    {
+        FigureArray array;
+        for (int i = 0; i < 1000; ++i) {
+            array.emplace<Hexagon>(Point(i, i), 1);
+        }
+        kept = array.get(500);
+        copy = array;
+        array.remove(size_t(500));
+        copy.transform(Affine::translation(1, 0));
+    }
+    EXPECT_EQ(copy.allocator(), PoolAllocator<Figure>(copy.allocator()));
+    EXPECT_NEAR(kept->center().x, 500, 1e-9);
+    EXPECT_EQ(kept->area(), Hexagon(Point(500, 500), 1).area());
+    EXPECT_NEAR(copy.at(500).center().x, 501, 1e-9);
+}
+
+TEST(FigurePoolTest, FiguresOutliveEveryArray) {
+    std::shared_ptr<const Figure> emplaced;
+    std::shared_ptr<const Figure> detached;
+    std::shared_ptr<const Figure> snapshotted;
+    {
+        FigureArray array;
+        FigureHandle handle = array.emplace<Rhombus>(Point(0, 0), 2, 4);
+        emplaced = array.get(handle);
+        array.transform(Affine::translation(1, 0));
+        detached = array.get(handle);
+
+        ConcurrentFigureArray concurrent;
+        concurrent.add(std::make_shared<Rhombus>(Point(3, 3), 2, 2));
+        snapshotted = concurrent.snapshot().get(size_t(0));
+    }
+    EXPECT_EQ(emplaced->area(), 4);
+    EXPECT_NEAR(emplaced->center().x, 0, 1e-12);
+    EXPECT_NE(emplaced, detached);
+    EXPECT_NEAR(detached->center().x, 1, 1e-12);
+    EXPECT_EQ(snapshotted->area(), 2);
+}
+
+static_assert(std::ranges::random_access_range<const FigureArray>);
+static_assert(std::ranges::sized_range<const FigureArray>);
+
+TEST(FigureViewTest, IteratesInOrder) {
+    FigureArray array = random_figures(100, 15);
+    size_t i = 0;
+    for (const Figure& figure : array) {
+        EXPECT_EQ(&figure, &array.at(i++));
+    }
+    EXPECT_EQ(i, array.size());
+    EXPECT_EQ(std::ranges::distance(array), 100);
+    EXPECT_EQ(&*(array.begin() + 42), &array.at(42));
+    EXPECT_EQ(&array.begin()[7], &array.at(7));
+}
+
+TEST(FigureViewTest, LazyPipeline) {
+    FigureArray array = random_figures(5000, 16);
+    BoundingBox region{Point(-10, -10), Point(10, 10)};
+    double min_area = 1.0;
+    auto inside = [&](const Figure& f) {
+        Point c = f.center();
+        return c.x >= region.min.x && c.x <= region.max.x && c.y >= region.min.y && c.y <= region.max.y;
+    };
+
+    auto query = array.of_type(FigureType::Hexagon)
+               | std::views::filter([&](const Figure& f) { return f.area() > min_area; })
+               | std::views::filter(inside)
+               | std::views::transform([](const Figure& f) { return f.area(); });
+
+    std::vector<double> expected;
+    for (size_t i = 0; i < array.size(); ++i) {
+        const Figure& f = array.at(i);
+        if (f.type() == FigureType::Hexagon && f.area() > min_area && inside(f)) {
+            expected.push_back(f.area());
+        }
+    }
+    std::vector<double> actual(query.begin(), query.end());
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(actual, expected);
+
+    size_t rhombi = std::ranges::distance(array.of_type(FigureType::Rhombus));
+    EXPECT_EQ(rhombi, array.count(FigureType::Rhombus));
+
+    auto areas = array.map([](const Figure& f) { return f.area(); });
+    EXPECT_NEAR(std::accumulate(areas.begin(), areas.end(), 0.0), array.total_area(), 1e-9);
+    auto large = array.filter([](const Figure& f) { return f.area() > 5; });
+    EXPECT_EQ(static_cast<size_t>(std::ranges::distance(large)),
+              array.parallel_count_if([](const Figure& f) { return f.area() > 5; }));
+}
+
+TEST(ConcurrentFigureArrayTest, SingleThread) {
+    ConcurrentFigureArray array;
+    EXPECT_EQ(array.size(), 0);
+    EXPECT_EQ(array.get(0), nullptr);
+    EXPECT_EQ(array.add(std::make_shared<Rhombus>(Point(0, 0), 2, 4)), 0);
+    std::vector<std::shared_ptr<Figure>> chunk;
+    for (int i = 0; i < 3000; ++i) {
+        chunk.push_back(std::make_shared<Hexagon>(Point(i, 0), 1));
+    }
+    EXPECT_EQ(array.add(chunk), 1);
+    EXPECT_EQ(array.size(), 3001);
+    EXPECT_EQ(array.get(2000), chunk[1999]);
+    EXPECT_EQ(array.count(FigureType::Hexagon), 3000);
+    EXPECT_NEAR(array.total_area(), 4 + 3000 * Hexagon(Point(0, 0), 1).area(), 1e-6);
+    EXPECT_THROW(array.add(std::shared_ptr<Figure>()), std::invalid_argument);
+    EXPECT_THROW(array.add(std::vector<std::shared_ptr<Figure>>{chunk[0], nullptr}), std::invalid_argument);
+    EXPECT_EQ(array.size(), 3001);
+
+    FigureArray copy = array.snapshot();
+    EXPECT_EQ(copy.size(), 3001);
+    EXPECT_NEAR(copy.total_area(), array.total_area(), 1e-6);
+    EXPECT_NE(copy.get(2000), array.get(2000));
+    copy.transform(Affine::translation(10, 0));
+    EXPECT_NEAR(array.get(2000)->center().x, 1999, 1e-9);
+    static_assert(std::is_same_v<decltype(array.get(0)), std::shared_ptr<const Figure>>);
+}
+
+TEST(ConcurrentFigureArrayTest, ProducersAndReader) {
+    ConcurrentFigureArray array;
+    const size_t producers = 4;
+    const size_t per_producer = 6000;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> reader_errors(0);
+
+    std::thread reader([&] {
+        size_t last = 0;
+        while (!done) {
+            size_t n = array.size();
+            if (n < last) ++reader_errors;
+            last = n;
+            if (n > 0) {
+                std::shared_ptr<const Figure> f = array.get(n - 1);
+                if (!f || f->area() <= 0) ++reader_errors;
+            }
+            if (array.total_area() < 0) ++reader_errors;
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < producers; ++t) {
+        writers.emplace_back([&, t] {
+            std::vector<std::shared_ptr<Figure>> chunk;
+            for (size_t i = 0; i < per_producer; ++i) {
+                auto figure = std::make_shared<Pentagon>(Point(t, i), 1);
+                if (i % 2 == 0) {
+                    array.add(figure);
+                } else {
+                    chunk.push_back(figure);
+                    if (chunk.size() == 100) {
+                        array.add(std::move(chunk));
+                        chunk.clear();
+                    }
+                }
+            }
+            array.add(std::move(chunk));
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(reader_errors, 0);
+    ASSERT_EQ(array.size(), producers * per_producer);
+    std::set<std::pair<double, double>> centers;
+    for (size_t i = 0; i < array.size(); ++i) {
+        Point c = array.get(i)->center();
+        centers.insert({std::round(c.x), std::round(c.y)});
+    }
+    EXPECT_EQ(centers.size(), producers * per_producer);
+    EXPECT_NEAR(array.total_area(), producers * per_producer * Pentagon(Point(0, 0), 1).area(), 1e-6);
+    EXPECT_EQ(array.count(FigureType::Pentagon), producers * per_producer);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();